@@ -0,0 +1,178 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "../matryoshka/data/FileSystem.h"
+#include "../matryoshka/data/FileSystemPool.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace matryoshka::data;
+
+namespace {
+constexpr FileSystem::SizeType DATA_SIZE = 64 * 1024 * 1024;
+constexpr int CHUNK_SIZE = 64 * 1024;
+constexpr int NUM_RANDOM_READS = 20000;
+constexpr int RANDOM_READ_SIZE = 4096;
+constexpr std::string_view CONTAINER_PATH = "benchmark_container.tmp";
+
+FileSystem::Chunk CreateText() {
+  std::string text;
+  text.reserve(DATA_SIZE + 256);
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> status(0, 4), duration(0, 99999);
+  static const char *STATES[] = {"200", "201", "304", "404", "500"};
+  for (int i = 0; static_cast<FileSystem::SizeType>(text.size()) < DATA_SIZE; ++i) {
+	text += R"({"id": )" + std::to_string(i) + R"(, "level": "info", "path": "/api/v1/items/)"
+		+ std::to_string(i % 1000) + R"(", "status": )" + STATES[status(generator)] + R"(, "duration_us": )"
+		+ std::to_string(duration(generator)) + "}\n";
+  }
+
+  FileSystem::Chunk data(DATA_SIZE);
+  std::memcpy(data.Data(), text.data(), DATA_SIZE);
+  return data;
+}
+
+FileSystem::Chunk CreateRandom() {
+  FileSystem::Chunk data(DATA_SIZE);
+  std::mt19937 generator(42);
+  for (FileSystem::SizeType i = 0; i < DATA_SIZE; ++i) {
+	data[i] = static_cast<unsigned char>(generator());
+  }
+  return data;
+}
+
+template<typename C>
+double Measure(C callback) {
+  const auto start = std::chrono::steady_clock::now();
+  callback();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Run(std::string_view name, const FileSystem::Chunk &data, util::Codec::Type codec, std::string_view profile) {
+  std::ofstream(CONTAINER_PATH.data(), std::ofstream::binary | std::ofstream::trunc).close();
+  double write_time = 0, read_time = 0, random_time = 0;
+  {
+	auto database = sqlite::Database::Create(CONTAINER_PATH, sqlite::Database::Options::Preset(profile).value());
+	auto file_system = std::get<FileSystem>(FileSystem::Open(std::move(std::get<sqlite::Database>(database))));
+	file_system.SetWriteOptions(FileSystem::WriteOptions().SetCodec(codec));
+
+	std::optional<File> file;
+	write_time = Measure([&]() {
+	  file = std::get<File>(file_system.Create(Path("data"), data.Copy(), CHUNK_SIZE));
+	});
+
+	FileSystem::Chunk output(DATA_SIZE);
+	read_time = Measure([&]() {
+	  if (file_system.Read(file.value(), 0, output.Data(), DATA_SIZE).has_value()) {
+		std::cerr << "Reading failed" << std::endl;
+	  }
+	});
+
+	std::mt19937 generator(42);
+	std::uniform_int_distribution<FileSystem::SizeType> offset(0, DATA_SIZE - RANDOM_READ_SIZE);
+	random_time = Measure([&]() {
+	  for (int i = 0; i < NUM_RANDOM_READS; ++i) {
+		if (file_system.Read(file.value(), offset(generator), output.Data(), RANDOM_READ_SIZE).has_value()) {
+		  std::cerr << "Reading failed" << std::endl;
+		}
+	  }
+	});
+  }
+
+  const auto container_size = static_cast<double>(std::filesystem::file_size(CONTAINER_PATH));
+  std::filesystem::remove(CONTAINER_PATH);
+  std::filesystem::remove(std::string(CONTAINER_PATH) + "-wal");
+  std::filesystem::remove(std::string(CONTAINER_PATH) + "-shm");
+
+  constexpr double MEBIBYTE = 1024 * 1024;
+  std::cout << std::left << std::setw(8) << name
+			<< std::setw(8) << (codec == util::Codec::Type::Store ? "store" : "lz")
+			<< std::setw(13) << profile
+			<< std::right << std::fixed << std::setprecision(2)
+			<< std::setw(10) << static_cast<double>(DATA_SIZE) / container_size
+			<< std::setw(14) << static_cast<double>(DATA_SIZE) / MEBIBYTE / write_time
+			<< std::setw(14) << static_cast<double>(DATA_SIZE) / MEBIBYTE / read_time
+			<< std::setw(16) << NUM_RANDOM_READS / random_time << std::endl;
+}
+
+void RunPool(const FileSystem::Chunk &data) {
+  std::ofstream(CONTAINER_PATH.data(), std::ofstream::binary | std::ofstream::trunc).close();
+  {
+	auto database = sqlite::Database::Create(CONTAINER_PATH, sqlite::Database::Options::ReadMostly());
+	auto file_system = std::get<FileSystem>(FileSystem::Open(std::move(std::get<sqlite::Database>(database))));
+	if (!file_system.Create(Path("data"), data.Copy(), CHUNK_SIZE)) {
+	  std::cerr << "Writing failed" << std::endl;
+	}
+  }
+
+  std::cout << std::left << std::setw(8) << "Threads" << std::right << std::setw(16) << "4 KiB reads/s" << std::endl;
+  const unsigned int maximal_threads = std::max(4u, std::thread::hardware_concurrency());
+  for (unsigned int num_threads = 1; num_threads <= maximal_threads; num_threads *= 2) {
+	auto pool = std::move(std::get<std::unique_ptr<FileSystemPool>>(
+		FileSystemPool::Open(CONTAINER_PATH, num_threads, sqlite::Database::Options::ReadMostly())));
+	const double time = Measure([&]() {
+	  std::vector<std::thread> threads;
+	  for (unsigned int t = 0; t < num_threads; ++t) {
+		threads.emplace_back([&, t]() {
+		  auto lease = pool->Acquire();
+		  const auto file = std::get<File>(lease->Open(Path("data")));
+		  std::mt19937 generator(t);
+		  std::uniform_int_distribution<FileSystem::SizeType> offset(0, DATA_SIZE - RANDOM_READ_SIZE);
+		  unsigned char output[RANDOM_READ_SIZE];
+		  for (int i = 0; i < NUM_RANDOM_READS; ++i) {
+			if (lease->Read(file, offset(generator), output, RANDOM_READ_SIZE).has_value()) {
+			  std::cerr << "Reading failed" << std::endl;
+			}
+		  }
+		});
+	  }
+	  for (auto &thread: threads) {
+		thread.join();
+	  }
+	});
+	std::cout << std::left << std::setw(8) << num_threads << std::right << std::fixed << std::setprecision(2)
+			  << std::setw(16) << num_threads * NUM_RANDOM_READS / time << std::endl;
+  }
+
+  std::filesystem::remove(CONTAINER_PATH);
+  std::filesystem::remove(std::string(CONTAINER_PATH) + "-wal");
+  std::filesystem::remove(std::string(CONTAINER_PATH) + "-shm");
+}
+}
+
+int main() {
+  std::cout << std::left << std::setw(8) << "Data" << std::setw(8) << "Codec" << std::setw(13) << "Profile"
+			<< std::right
+			<< std::setw(10) << "Ratio" << std::setw(14) << "Write MiB/s" << std::setw(14) << "Read MiB/s"
+			<< std::setw(16) << "4 KiB reads/s" << std::endl;
+
+  const auto text = CreateText(), random = CreateRandom();
+  for (auto codec: {util::Codec::Type::Store, util::Codec::Type::Lz}) {
+	Run("text", text, codec, "default");
+	Run("random", random, codec, "default");
+  }
+
+  // The effect of the database tuning
+  for (auto profile: {"bulk-import", "read-mostly", "durable"}) {
+	Run("text", text, util::Codec::Type::Store, profile);
+  }
+
+  // Concurrent readers using their own connection
+  std::cout << std::endl;
+  RunPool(text);
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+"""
+Measure the requests per second the WebDAV server answers for a growing number of concurrent clients.
+
+Start the server with the worker count of interest first, e.g. "MatryoshkaServer --threads 4 container.db", and
+compare the results between worker counts: python3 server_load.py /some/file --clients 1 2 4 8 16
+
+With "--upload BYTES", each client repeatedly PUTs a body of the given size to a path of its own instead, which
+measures the ingest throughput under concurrent uploads.
+"""
+
+import argparse
+import http.client
+import threading
+import time
+from typing import List, Optional
+
+
+def run_client(host: str, port: int, path: str, body: Optional[bytes], deadline: float, counts: List[int], index: int):
+    connection = http.client.HTTPConnection(host, port)
+    while time.monotonic() < deadline:
+        if body is None:
+            connection.request("GET", path)
+        else:
+            connection.request("PUT", "{}.{}".format(path, index), body=body)
+        response = connection.getresponse()
+        response.read()
+        if response.status not in (200, 201, 204):
+            raise RuntimeError("Unexpected status {}".format(response.status))
+        counts[index] += 1
+    connection.close()
+
+
+def measure(host: str, port: int, path: str, body: Optional[bytes], num_clients: int, duration: float) -> float:
+    counts = [0] * num_clients
+    deadline = time.monotonic() + duration
+    threads = [
+        threading.Thread(target=run_client, args=(host, port, path, body, deadline, counts, i))
+        for i in range(num_clients)
+    ]
+    start = time.monotonic()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return sum(counts) / (time.monotonic() - start)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Load test for the Matryoshka WebDAV server")
+    parser.add_argument("path", help="The inner path of the file requested")
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--clients", type=int, nargs="+", default=[1, 2, 4, 8, 16])
+    parser.add_argument("--duration", type=float, default=10.0, help="The seconds per measurement")
+    parser.add_argument("--upload", type=int, default=None, help="The size of the bodies uploaded per request")
+    arguments = parser.parse_args()
+    upload = None if arguments.upload is None else bytes(i % 251 for i in range(arguments.upload))
+
+    print("{:>8} {:>14} {:>10}".format("Clients", "Requests/s", "MiB/s"))
+    for clients in arguments.clients:
+        rate = measure(arguments.host, arguments.port, arguments.path, upload, clients, arguments.duration)
+        mebibytes = 0.0 if upload is None else rate * len(upload) / (1024 * 1024)
+        print("{:>8} {:>14.2f} {:>10.2f}".format(clients, rate, mebibytes))
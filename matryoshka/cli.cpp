@@ -7,10 +7,15 @@ You should have received a copy of the GNU Affero General Public License along w
 */
 
 #include "data/FileSystem.h"
+#include "data/Importer.h"
+#include "data/FileSystemPool.h"
 
 #include <CLI/CLI.hpp>
 
 #include <limits>
+#include <filesystem>
+#include <chrono>
+#include <algorithm>
 
 using namespace matryoshka::data;
 
@@ -20,11 +25,19 @@ enum class ReturnCode : int {
   FilesystemInvalid = 2,
   FileNotFound = 3,
   FilePushFailed = 4,
-  FilePullFailed = 5
+  FilePullFailed = 5,
+  StatisticsFailed = 6,
+  FileMoveFailed = 7,
+  FileCopyFailed = 8
 };
 
-FileSystem Open(std::string_view path) {
-  auto database = sqlite::Database::Create(path);
+FileSystem Open(std::string_view path, std::string_view profile) {
+  const auto options = sqlite::Database::Options::Preset(profile);
+  if (!options.has_value()) {
+	throw CLI::RuntimeError("Unknown database profile", static_cast<int>(ReturnCode::SQLiteInvalid));
+  }
+
+  auto database = sqlite::Database::Create(path, options.value());
   if (!database) {
 	throw CLI::RuntimeError("Unable to open the SQLite database", static_cast<int>(ReturnCode::SQLiteInvalid));
   }
@@ -38,15 +51,18 @@ FileSystem Open(std::string_view path) {
 }
 
 int main(int argc, char **argv) {
-  std::string container_file, source, destination;
-  int chunk_size = 8192;
+  std::string container_file, source, destination, profile = "default";
+  int chunk_size = 8192, buffer_size = 1024 * 1024, jobs = 1, batch_size = 1000;
+  bool deduplicate = false, content_defined = false, compress = false, recursive = false;
 
   CLI::App app("Matryoshka - Command line interface");
   app.add_option("container_file", container_file, "The Matryoshka file")->check(CLI::ExistingFile);
+  app.add_option("--profile", profile, "The database tuning: default, bulk-import, read-mostly or durable.")
+	  ->check(CLI::IsMember({"default", "bulk-import", "read-mostly", "durable"}));
 
   // "list" command
   app.add_subcommand("list", "Show all files")->alias("ls")->final_callback([&]() {
-	FileSystem file_system = Open(container_file);
+	FileSystem file_system = Open(container_file, profile);
 	std::vector<Path> paths;
 	file_system.Find(paths);
 	for (auto &path: paths) {
@@ -57,21 +73,98 @@ int main(int argc, char **argv) {
 
   // "push" command
   auto push = app.add_subcommand("push", "Push a file to the Matryoshka file")->final_callback([&]() {
-	FileSystem file_system = Open(container_file);
-	auto result = file_system.Create(Path(destination), source, chunk_size);
-	if (!result) {
-	  throw CLI::RuntimeError(std::string(Error::Message(std::get<Error>(std::move(result)))),
+	FileSystem file_system = Open(container_file, profile);
+	auto options = FileSystem::WriteOptions()
+		.SetDeduplicate(deduplicate)
+		.SetCodec(compress ? util::Codec::Type::Lz : util::Codec::Type::Store)
+		.SetBufferSize(buffer_size);
+	if (content_defined) {
+	  options.SetContentDefinedChunking(util::Chunker::Parameters::Create(chunk_size));
+	}
+	file_system.SetWriteOptions(options);
+	if (!recursive) {
+	  auto result = file_system.Create(Path(destination), source, chunk_size);
+	  if (!result) {
+		throw CLI::RuntimeError(std::string(Error::Message(std::get<Error>(std::move(result)))),
+								static_cast<int>(ReturnCode::FilePushFailed));
+	  }
+	  return;
+	}
+
+	// Push all files below the directory in batches, skipping the ones failing
+	std::vector<Importer::Job> import_jobs;
+	for (const auto &entry: std::filesystem::recursive_directory_iterator(source)) {
+	  if (entry.is_regular_file()) {
+		const std::string relative_path = entry.path().lexically_relative(source).generic_string();
+		import_jobs.push_back(Importer::Job{Path(destination + "/" + relative_path), entry.path().string()});
+	  }
+	}
+	Importer importer(&file_system, Importer::Options{static_cast<std::size_t>(jobs),
+													  Importer::DEFAULT_BUFFER_SIZE, batch_size, chunk_size});
+	auto summary = importer.Import(import_jobs, [](const Importer::Job &job, const Error &error) {
+	  std::cerr << job.file_path << ": " << Error::Message(Error(error)) << std::endl;
+	});
+	if (!summary) {
+	  throw CLI::RuntimeError(std::string(Error::Message(std::get<Error>(std::move(summary)))),
+							  static_cast<int>(ReturnCode::FilePushFailed));
+	} else if (summary->num_failed > 0) {
+	  throw CLI::RuntimeError(std::to_string(summary->num_failed) + " files could not be pushed",
 							  static_cast<int>(ReturnCode::FilePushFailed));
 	}
   });
-  push->add_option("source", source, "The file to be pushed")->required()->check(CLI::ExistingFile);
+  push->add_option("source", source, "The file to be pushed")->required()->check(CLI::ExistingPath);
   push->add_option("destination", destination, "The inner path in the Matryoshka file")->required();
+  push->add_flag("-r,--recursive", recursive, "Push all files within the source directory.");
+  push->add_option("--batch-size", batch_size, "The number of files committed together when pushing recursively.")
+	  ->check(CLI::Range(1, std::numeric_limits<int>::max()));
+  push->add_option("-j,--jobs", jobs, "The number of threads reading files when pushing recursively.")
+	  ->check(CLI::Range(1, 256));
   push->add_option("chunk_size", chunk_size, "The chunk size used internally.")
 	  ->check(CLI::Range(1, std::numeric_limits<int>::max()));
+  push->add_flag("--deduplicate", deduplicate, "Store chunks with identical content only once.");
+  push->add_flag("--content-defined",
+				 content_defined,
+				 "Cut chunks at content-defined boundaries, using the chunk size as average.");
+  push->add_flag("--compress", compress, "Compress the chunks, if they shrink.");
+  push->add_option("--buffer-size", buffer_size, "The maximal number of bytes held in memory per uncompressed chunk.")
+	  ->check(CLI::Range(1, std::numeric_limits<int>::max()));
 
   // "pull" command
   auto pull = app.add_subcommand("pull", "Pull a file from the Matryoshka file")->final_callback([&]() {
-	FileSystem file_system = Open(container_file);
+	FileSystem file_system = Open(container_file, profile);
+
+	// The reading connections are opened once, with the same tuning as the main one
+	std::unique_ptr<FileSystemPool> pool;
+	if (recursive || jobs > 1) {
+	  auto pool_container = FileSystemPool::Open(container_file,
+												 static_cast<std::size_t>(jobs),
+												 sqlite::Database::Options::Preset(profile).value());
+	  if (!pool_container) {
+		throw CLI::RuntimeError(std::string(Error::Message(std::get<Error>(std::move(pool_container)))),
+								static_cast<int>(ReturnCode::SQLiteInvalid));
+	  }
+	  pool = std::get<std::unique_ptr<FileSystemPool>>(std::move(pool_container));
+	}
+
+	if (recursive) {
+	  // Extract all matching files with several connections, each writing whole files
+	  const auto begin = std::chrono::steady_clock::now();
+	  const auto summary = pool->Export(
+		  Path(source), destination, [](const Path &path, const Error &error) {
+			std::cerr << path << ": " << Error::Message(Error(error)) << std::endl;
+		  });
+	  const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - begin;
+	  const double megabytes = static_cast<double>(summary.bytes_exported) / (1000.0 * 1000.0);
+	  std::cout << "Pulled " << summary.num_exported << " files (" << megabytes << " MB) in " << seconds.count()
+				<< " s: " << megabytes / std::max(seconds.count(), 1e-9) << " MB/s" << std::endl;
+	  if (summary.num_failed > 0) {
+		throw CLI::RuntimeError(std::to_string(summary.num_failed) + " files could not be pulled",
+								static_cast<int>(ReturnCode::FilePullFailed));
+	  }
+	  return;
+	} else if (std::filesystem::exists(destination)) {
+	  throw CLI::RuntimeError("The destination file exists already", static_cast<int>(ReturnCode::FilePullFailed));
+	}
 
 	// Open the file
 	auto file_container = file_system.Open(Path(source));
@@ -82,14 +175,61 @@ int main(int argc, char **argv) {
 
 	// Read its content into the memory
 	auto file = Result<File>::Get(std::move(file_container));
-	auto result = file_system.Read(file, destination, 0, file_system.Size(file), true);
+	auto result = file_system.Read(file, destination, 0, file_system.Size(file), true, true, pool.get());
 	if (result.has_value()) {
 	  throw CLI::RuntimeError(std::string(Error::Message(Error(result.value()))),
 							  static_cast<int>(ReturnCode::FilePullFailed));
 	}
   });
-  pull->add_option("source", source, "The inner path in the Matryoshka file")->required();
-  pull->add_option("destination", destination, "The destination file")->required()->check(CLI::NonexistentPath);
+  pull->add_option("source", source, "The inner path in the Matryoshka file, or a pattern when pulling recursively")
+	  ->required();
+  pull->add_option("destination", destination, "The destination file, or a directory when pulling recursively")
+	  ->required();
+  pull->add_flag("-r,--recursive", recursive, "Pull all files matching the source into the destination directory.");
+  pull->add_option("-j,--jobs", jobs, "The number of connections reading concurrently.")
+	  ->check(CLI::Range(1, 256));
+
+  // "move" command
+  auto move = app.add_subcommand("move", "Move a file or folder within the Matryoshka file")->alias("mv")
+	  ->final_callback([&]() {
+		FileSystem file_system = Open(container_file, profile);
+		auto result = file_system.Move(Path(source), Path(destination));
+		if (result.has_value()) {
+		  throw CLI::RuntimeError(std::string(Error::Message(Error(result.value()))),
+								  static_cast<int>(ReturnCode::FileMoveFailed));
+		}
+	  });
+  move->add_option("source", source, "The inner path of the file or folder")->required();
+  move->add_option("destination", destination, "The new inner path")->required();
+
+  // "copy" command
+  auto copy = app.add_subcommand("copy", "Copy a file or folder within the Matryoshka file")->alias("cp")
+	  ->final_callback([&]() {
+		FileSystem file_system = Open(container_file, profile);
+		auto result = file_system.Copy(Path(source), Path(destination));
+		if (result.has_value()) {
+		  throw CLI::RuntimeError(std::string(Error::Message(Error(result.value()))),
+								  static_cast<int>(ReturnCode::FileCopyFailed));
+		}
+	  });
+  copy->add_option("source", source, "The inner path of the file or folder")->required();
+  copy->add_option("destination", destination, "The inner path of the copy")->required();
+
+  // "stats" command
+  app.add_subcommand("stats", "Show the effect of deduplication")->final_callback([&]() {
+	FileSystem file_system = Open(container_file, profile);
+	auto statistics = file_system.Deduplication();
+	if (!statistics) {
+	  throw CLI::RuntimeError(std::string(Error::Message(std::get<Error>(std::move(statistics)))),
+							  static_cast<int>(ReturnCode::StatisticsFailed));
+	}
+
+	std::cout << "Referenced chunks: " << statistics->references << std::endl
+			  << "Unique chunks: " << statistics->unique_chunks << std::endl
+			  << "Referenced bytes: " << statistics->logical_size << std::endl
+			  << "Stored bytes: " << statistics->stored_size << std::endl
+			  << "Deduplication ratio: " << statistics->Ratio() << std::endl;
+  });
 
   CLI11_PARSE(app, argc, argv);
   return static_cast<int>(ReturnCode::Success);
@@ -83,6 +83,9 @@ class Error {
   std::variant<errors::Backend, errors::Io, errors::ArgumentError> data_;
 };
 
+template<typename T>
+using Result = sqlite::Result<T, Error>;
+
 }
 
 #endif //MATRYOSHKA_MATRYOSHKA_DATA_ERROR_H_
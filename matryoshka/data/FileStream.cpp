@@ -0,0 +1,148 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "FileStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace matryoshka::data {
+
+namespace {
+constexpr std::size_t NO_CHUNK = std::numeric_limits<std::size_t>::max();
+}
+
+FileStream::FileStream(const sqlite::Database *database,
+					   std::string_view table,
+					   util::Codec::Type codec,
+					   std::vector<sqlite::Database::RowId> &&chunks,
+					   std::vector<SizeType> &&offsets,
+					   int chunk_size,
+					   SizeType size) noexcept
+	: database_(database),
+	  table_(table),
+	  codec_(codec),
+	  chunks_(std::move(chunks)),
+	  offsets_(std::move(offsets)),
+	  size_(size),
+	  position_(0),
+	  last_position_(0),
+	  chunk_size_(chunk_size),
+	  blob_(std::nullopt),
+	  blob_index_(NO_CHUNK),
+	  buffer_index_(NO_CHUNK),
+	  buffer_() {
+}
+
+bool FileStream::Seek(SizeType position) noexcept {
+  if (position < 0 || position > size_) {
+	return false;
+  }
+  position_ = position;
+  return true;
+}
+
+Result<FileStream::SizeType> FileStream::Read(void *destination, SizeType length) {
+  auto *output = static_cast<unsigned char *>(destination);
+  const bool is_sequential = position_ == last_position_;
+  length = std::min(length, size_ - position_);
+
+  SizeType bytes_read = 0;
+  while (bytes_read < length) {
+	const auto chunk_index = this->FindChunk(position_);
+	if (chunk_index >= chunks_.size()) {
+	  return Result<SizeType>::Fail(errors::Io::OutOfBounds);
+	}
+	const SizeType chunk_end = chunk_index + 1 < offsets_.size() ? offsets_[chunk_index + 1] : size_;
+	const auto chunk_length = static_cast<int>(chunk_end - offsets_[chunk_index]);
+	const auto chunk_offset = static_cast<int>(position_ - offsets_[chunk_index]);
+	const auto num_bytes = static_cast<int>(std::min<SizeType>(chunk_length - chunk_offset, length - bytes_read));
+
+	// Small sequential reads are served from a whole chunk read ahead, everything else directly from the blob.
+	// Compressed chunks are always decoded as a whole.
+	sqlite::Status status;
+	const bool is_compressed = codec_ != util::Codec::Type::Store;
+	if (buffer_index_ != chunk_index && ((is_sequential && num_bytes < chunk_length) || is_compressed)) {
+	  status = this->Prefetch(chunk_index);
+	}
+	if (status && buffer_index_ == chunk_index) {
+	  std::memcpy(output + bytes_read, buffer_.Data() + chunk_offset, num_bytes);
+	} else if (status) {
+	  status = this->OpenBlob(chunk_index).Than([&] {
+		return blob_->Read(output + bytes_read, chunk_offset, num_bytes);
+	  });
+	}
+
+	if (!status) {
+	  return Result<SizeType>::Fail(status);
+	}
+	position_ += num_bytes;
+	bytes_read += num_bytes;
+  }
+
+  last_position_ = position_;
+  return Result<SizeType>::Ok(bytes_read);
+}
+
+std::size_t FileStream::FindChunk(SizeType position) const noexcept {
+  // Sequential reads mostly stay within the chunk used last
+  const std::size_t last_index = blob_index_ != NO_CHUNK ? blob_index_ : buffer_index_;
+  if (last_index < offsets_.size() && offsets_[last_index] <= position
+	  && (last_index + 1 == offsets_.size() || position < offsets_[last_index + 1])) {
+	return last_index;
+  }
+
+  // Chunks may differ in size, so search the last one starting before the position
+  const auto next = std::upper_bound(offsets_.begin(), offsets_.end(), position);
+  return next != offsets_.begin() ? static_cast<std::size_t>(next - offsets_.begin()) - 1 : NO_CHUNK;
+}
+
+sqlite::Status FileStream::OpenBlob(std::size_t chunk_index) {
+  if (blob_.has_value() && blob_index_ == chunk_index) {
+	return sqlite::Status();
+  }
+
+  // Reopening an existing handle is much cheaper than opening a new one
+  auto blob = blob_.has_value()
+			  ? sqlite::BlobReader::Open(std::move(blob_.value()), chunks_[chunk_index])
+			  : sqlite::BlobReader::Open(*database_, chunks_[chunk_index], table_, "data");
+  blob_.reset();
+  blob_index_ = NO_CHUNK;
+  if (!blob) {
+	return static_cast<sqlite::Status>(blob);
+  }
+
+  blob_.emplace(std::move(std::get<sqlite::BlobReader>(blob)));
+  blob_index_ = chunk_index;
+  return sqlite::Status();
+}
+
+sqlite::Status FileStream::Prefetch(std::size_t chunk_index) {
+  buffer_index_ = NO_CHUNK;
+  if (codec_ != util::Codec::Type::Store) {
+	return this->OpenBlob(chunk_index).Than([&] {
+	  return util::Codec::Decode(*blob_, buffer_);
+	}).Than([&] {
+	  buffer_index_ = chunk_index;
+	  return sqlite::Status();
+	});
+  }
+
+  if (!buffer_) {
+	buffer_ = sqlite::Blob<true>(chunk_size_);
+  }
+  return this->OpenBlob(chunk_index).Than([&] {
+	return blob_->Read(buffer_.Data(), 0, std::min(blob_->Size(), chunk_size_));
+  }).Than([&] {
+	buffer_index_ = chunk_index;
+	return sqlite::Status();
+  });
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_MATRYOSHKA_DATA_FILESTREAM_H_
+#define MATRYOSHKA_MATRYOSHKA_DATA_FILESTREAM_H_
+
+#include "Error.h"
+#include "sqlite/Database.h"
+#include "sqlite/BlobReader.h"
+#include "sqlite/Blob.h"
+#include "util/Codec.h"
+
+#include <optional>
+#include <vector>
+#include <string_view>
+
+namespace matryoshka::data {
+class FileSystem;
+
+/**
+ * A stateful handle for reading a file in many small pieces. The chunk layout is queried only once, the blob handle
+ * is reused between reads, and sequential access reads whole chunks ahead into an internal buffer.
+ */
+class FileStream {
+ public:
+  using SizeType = sqlite::BlobBase::SizeType;
+
+  FileStream(FileStream &&other) noexcept = default;
+  FileStream(FileStream const &) = delete;
+  FileStream &operator=(FileStream const &) = delete;
+
+  [[nodiscard]] inline SizeType Size() const noexcept {
+	return size_;
+  }
+
+  [[nodiscard]] inline SizeType Tell() const noexcept {
+	return position_;
+  }
+
+  /**
+   * Set the position of the next read.
+   * @param position The offset in the file. It may be at most the size of the file.
+   * @return True, if the position is valid.
+   */
+  bool Seek(SizeType position) noexcept;
+
+  /**
+   * Read from the current position and advance it.
+   * @param destination The memory written to. It needs to hold at least length bytes.
+   * @param length The maximal number of bytes read.
+   * @return The number of bytes read, which is less than length only at the end of the file.
+   */
+  Result<SizeType> Read(void *destination, SizeType length);
+
+  inline Result<SizeType> Read(SizeType position, void *destination, SizeType length) {
+	return this->Seek(position) ? this->Read(destination, length) : Result<SizeType>::Fail(errors::Io::OutOfBounds);
+  }
+
+ protected:
+  friend class FileSystem;
+
+  FileStream(const sqlite::Database *database,
+			 std::string_view table,
+			 util::Codec::Type codec,
+			 std::vector<sqlite::Database::RowId> &&chunks,
+			 std::vector<SizeType> &&offsets,
+			 int chunk_size,
+			 SizeType size) noexcept;
+
+ private:
+  [[nodiscard]] std::size_t FindChunk(SizeType position) const noexcept;
+  sqlite::Status OpenBlob(std::size_t chunk_index);
+  sqlite::Status Prefetch(std::size_t chunk_index);
+
+  const sqlite::Database *database_;
+  std::string_view table_;
+  util::Codec::Type codec_;
+  std::vector<sqlite::Database::RowId> chunks_;
+  std::vector<SizeType> offsets_;
+  SizeType size_, position_, last_position_;
+  int chunk_size_;
+
+  std::optional<sqlite::BlobReader> blob_;
+  std::size_t blob_index_, buffer_index_;
+  sqlite::Blob<true> buffer_;
+};
+}
+
+#endif //MATRYOSHKA_MATRYOSHKA_DATA_FILESTREAM_H_
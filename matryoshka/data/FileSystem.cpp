@@ -7,20 +7,28 @@ You should have received a copy of the GNU Affero General Public License along w
 */
 
 #include "FileSystem.h"
+#include "FileStream.h"
+#include "FileSystemPool.h"
 #include "sqlite/PreparedStatement.h"
 #include "sqlite/BlobReader.h"
+#include "sqlite/BlobWriter.h"
 #include "sqlite/Transaction.h"
 #include "util/ContinuousReader.h"
 #include "util/ChunkReader.h"
 #include "util/Cache.h"
+#include "util/OutputFile.h"
+#include "util/InputFile.h"
 
+#include <sqlite3.h>
 #include <cassert>
+#include <cstring>
 #include <sstream>
 #include <utility>
 #include <numeric>
 #include <algorithm>
 #include <fstream>
 #include <filesystem>
+#include <chrono>
 
 using namespace matryoshka::data::sqlite;
 
@@ -34,6 +42,21 @@ FileSystem::FileSystem(sqlite::Database &&database,
 					   sqlite::PreparedStatement &&glob_statement,
 					   sqlite::PreparedStatement &&size_statement,
 					   sqlite::PreparedStatement &&delete_statement,
+					   sqlite::PreparedStatement &&stream_statement,
+					   sqlite::PreparedStatement &&reference_statement,
+					   sqlite::PreparedStatement &&layout_statement,
+					   sqlite::PreparedStatement &&dimension_statement,
+					   sqlite::PreparedStatement &&resize_statement,
+					   sqlite::PreparedStatement &&remove_statement,
+					   sqlite::PreparedStatement &&stamp_statement,
+					   sqlite::PreparedStatement &&stat_statement,
+					   sqlite::PreparedStatement &&list_statement,
+					   sqlite::PreparedStatement &&move_statement,
+					   sqlite::PreparedStatement &&rename_statement,
+					   sqlite::PreparedStatement &&copy_header_statement,
+					   sqlite::PreparedStatement &&copy_chunks_statement,
+					   sqlite::PreparedStatement &&share_statement,
+					   util::ContentStore &&content,
 					   util::MetaTable meta_table) noexcept
 	: database_(std::move(database)),
 	  handle_statement_(std::move(handle_statement)),
@@ -43,9 +66,28 @@ FileSystem::FileSystem(sqlite::Database &&database,
 	  glob_statement_(std::move(glob_statement)),
 	  size_statement_(std::move(size_statement)),
 	  delete_statement_(std::move(delete_statement)),
-	  meta_(std::move(meta_table)) {
+	  stream_statement_(std::move(stream_statement)),
+	  reference_statement_(std::move(reference_statement)),
+	  layout_statement_(std::move(layout_statement)),
+	  dimension_statement_(std::move(dimension_statement)),
+	  resize_statement_(std::move(resize_statement)),
+	  remove_statement_(std::move(remove_statement)),
+	  stamp_statement_(std::move(stamp_statement)),
+	  stat_statement_(std::move(stat_statement)),
+	  list_statement_(std::move(list_statement)),
+	  move_statement_(std::move(move_statement)),
+	  rename_statement_(std::move(rename_statement)),
+	  copy_header_statement_(std::move(copy_header_statement)),
+	  copy_chunks_statement_(std::move(copy_chunks_statement)),
+	  share_statement_(std::move(share_statement)),
+	  content_(std::move(content)),
+	  meta_(std::move(meta_table)),
+	  options_() {
   assert(handle_statement_ && chunk_statement_ && header_statement_ && blob_statement_ && glob_statement_
-			 && size_statement_);
+			 && size_statement_ && stream_statement_ && reference_statement_ && layout_statement_ && dimension_statement_
+			 && resize_statement_ && remove_statement_ && stamp_statement_ && stat_statement_
+			 && list_statement_ && move_statement_ && rename_statement_ && copy_header_statement_
+			 && copy_chunks_statement_ && share_statement_);
 }
 
 FileSystem::FileSystem(FileSystem &&other) noexcept: database_(std::move(other.database_)),
@@ -56,22 +98,97 @@ FileSystem::FileSystem(FileSystem &&other) noexcept: database_(std::move(other.d
 													 glob_statement_(std::move(other.glob_statement_)),
 													 size_statement_(std::move(other.size_statement_)),
 													 delete_statement_(std::move(other.delete_statement_)),
-													 meta_(std::move(other.meta_)) {
+													 stream_statement_(std::move(other.stream_statement_)),
+													 reference_statement_(std::move(other.reference_statement_)),
+													 layout_statement_(std::move(other.layout_statement_)),
+													 dimension_statement_(std::move(other.dimension_statement_)),
+													 resize_statement_(std::move(other.resize_statement_)),
+													 remove_statement_(std::move(other.remove_statement_)),
+													 stamp_statement_(std::move(other.stamp_statement_)),
+													 stat_statement_(std::move(other.stat_statement_)),
+													 list_statement_(std::move(other.list_statement_)),
+													 move_statement_(std::move(other.move_statement_)),
+													 rename_statement_(std::move(other.rename_statement_)),
+													 copy_header_statement_(std::move(other.copy_header_statement_)),
+													 copy_chunks_statement_(std::move(other.copy_chunks_statement_)),
+													 share_statement_(std::move(other.share_statement_)),
+													 content_(std::move(other.content_)),
+													 meta_(std::move(other.meta_)),
+													 options_(other.options_) {
 }
 
 Result<FileSystem> FileSystem::Open(sqlite::Database &&database) noexcept {
   static constexpr std::string_view SQL_CREATE_META =
-	  "CREATE TABLE {meta} (id INTEGER PRIMARY KEY, path TEXT UNIQUE NOT NULL, type INTEGER, flags INTEGER, chunk_size INTEGER NOT NULL)";
+	  "CREATE TABLE {meta} (id INTEGER PRIMARY KEY, path TEXT UNIQUE NOT NULL, type INTEGER, flags INTEGER, chunk_size INTEGER NOT NULL, size INTEGER NOT NULL DEFAULT 0, chunks INTEGER NOT NULL DEFAULT 0, last_chunk_size INTEGER NOT NULL DEFAULT 0, hash BLOB, modified INTEGER, parent INTEGER REFERENCES {meta} (id) ON DELETE CASCADE)";
   static constexpr std::string_view SQL_CREATE_DATA =
-	  "CREATE TABLE IF NOT EXISTS {data} (chunk_id INTEGER PRIMARY KEY, file_id INTEGER NOT NULL, chunk_num INTEGER NOT NULL, data BLOB NOT NULL, CONSTRAINT unq UNIQUE (file_id, chunk_num), FOREIGN KEY(file_id) REFERENCES {meta} (id) ON DELETE CASCADE ON UPDATE CASCADE)";
+	  "CREATE TABLE IF NOT EXISTS {data} (chunk_id INTEGER PRIMARY KEY, file_id INTEGER NOT NULL, chunk_num INTEGER NOT NULL, data BLOB NOT NULL, content_id INTEGER REFERENCES {content} (content_id), chunk_offset INTEGER, CONSTRAINT unq UNIQUE (file_id, chunk_num), FOREIGN KEY(file_id) REFERENCES {meta} (id) ON DELETE CASCADE ON UPDATE CASCADE)";
+  static constexpr std::string_view SQL_CREATE_CONTENT =
+	  "CREATE TABLE IF NOT EXISTS {content} (content_id INTEGER PRIMARY KEY, hash BLOB UNIQUE NOT NULL, refs INTEGER NOT NULL, data BLOB NOT NULL)";
+  static constexpr std::string_view SQL_CREATE_RELEASE = R"(
+	CREATE TRIGGER IF NOT EXISTS Matryoshka_Release AFTER DELETE ON {data} WHEN old.content_id IS NOT NULL
+	BEGIN
+	  UPDATE {content} SET refs = refs - 1 WHERE content_id = old.content_id;
+	  DELETE FROM {content} WHERE content_id = old.content_id AND refs <= 0;
+	END
+  )";
+  static constexpr std::string_view SQL_CREATE_OFFSETS =
+	  "CREATE INDEX IF NOT EXISTS Matryoshka_Offsets ON {data} (file_id, chunk_offset) WHERE chunk_offset IS NOT NULL";
+  static constexpr std::string_view SQL_CREATE_CHILDREN =
+	  "CREATE INDEX IF NOT EXISTS Matryoshka_Children ON {meta} (parent, path)";
   static constexpr std::string_view SQL_GET_HANDLE = "SELECT id FROM {meta} WHERE path = ? AND type = ?";
   static constexpr std::string_view SQL_GLOB = "SELECT path FROM {meta} WHERE path GLOB ? AND type = ?";
-  static constexpr std::string_view SQL_SIZE = "SELECT COALESCE(SUM(LENGTH(data)), 0) FROM {data} WHERE file_id = ?";
+  static constexpr std::string_view SQL_SIZE = "SELECT size FROM {meta} WHERE id = ?";
   static constexpr std::string_view SQL_DELETE = "DELETE FROM {meta} WHERE id = ?";
+  static constexpr std::string_view SQL_STREAM = R"(
+	SELECT COALESCE(content_id, chunk_id), {meta}.chunk_size, {meta}.size, {meta}.flags, COALESCE(chunk_offset, chunk_num * {meta}.chunk_size) FROM {data}
+	INNER JOIN {meta} ON {meta}.id={data}.file_id
+	WHERE file_id = ?
+	ORDER BY chunk_num ASC
+  )";
+  static constexpr std::string_view SQL_INSERT_REFERENCE =
+	  "INSERT INTO {data} (file_id, chunk_num, chunk_offset, data, content_id) VALUES (?, ?, ?, x'', ?)";
+  static constexpr std::string_view SQL_UPDATE_LAYOUT = R"(
+	UPDATE {meta} SET
+	  chunks = (SELECT COUNT(*) FROM {data} WHERE file_id = {meta}.id),
+	  last_chunk_size = size - COALESCE((SELECT MAX(chunk_offset) FROM {data} WHERE file_id = {meta}.id), 0)
+	WHERE id = ?
+  )";
+  static constexpr std::string_view SQL_GET_LAYOUT =
+	  "SELECT COALESCE(flags, 0), chunk_size, size, chunks, last_chunk_size FROM {meta} WHERE id = ?";
+  static constexpr std::string_view SQL_RESIZE =
+	  "UPDATE {meta} SET chunk_size = ?, size = ?, chunks = ?, last_chunk_size = ? WHERE id = ?";
+  static constexpr std::string_view SQL_REMOVE_CHUNKS =
+	  "DELETE FROM {data} WHERE file_id = ? AND chunk_num BETWEEN ? AND ?";
+  static constexpr std::string_view SQL_STAMP = "UPDATE {meta} SET hash = ?, modified = ? WHERE id = ?";
+  static constexpr std::string_view SQL_STAT = "SELECT size, modified, hash FROM {meta} WHERE id = ?";
+  static constexpr std::string_view SQL_LIST =
+	  "SELECT path, type, size, modified, hash, id FROM {meta} WHERE parent IS ? ORDER BY path";
+  static constexpr std::string_view SQL_MOVE = "UPDATE {meta} SET path = ?, parent = ? WHERE id = ?";
+  static constexpr std::string_view SQL_RENAME =
+	  "UPDATE {meta} SET path = ? || substr(path, ?) WHERE path >= ? AND path < ?";
+  static constexpr std::string_view SQL_COPY_HEADER = R"(
+	INSERT INTO {meta} (path, type, flags, chunk_size, size, chunks, last_chunk_size, hash, modified, parent)
+	SELECT ?, type, flags, chunk_size, size, chunks, last_chunk_size, hash, modified, ? FROM {meta} WHERE id = ?
+  )";
+  static constexpr std::string_view SQL_COPY_CHUNKS = R"(
+	INSERT INTO {data} (file_id, chunk_num, data, content_id, chunk_offset)
+	SELECT ?, chunk_num, data, content_id, chunk_offset FROM {data} WHERE file_id = ?
+  )";
+  static constexpr std::string_view SQL_SHARE = R"(
+	UPDATE {content} SET refs = refs + (SELECT COUNT(*) FROM {data} WHERE file_id = ? AND content_id = {content}.content_id)
+	WHERE content_id IN (SELECT content_id FROM {data} WHERE file_id = ?)
+  )";
 
   auto meta = util::MetaTable::Load(database);
-  if (!meta.empty() && meta[0].Id() != CURRENT_VERSION) {
+  if (!meta.empty() && meta[0].Id() > CURRENT_VERSION) {
 	return Result<FileSystem>::Fail(errors::Io::InvalidDatabaseVersion);
+  } else if (!meta.empty() && meta[0].Id() < CURRENT_VERSION) {
+	// Upgrade older containers in place
+	auto status = FileSystem::Migrate(database, meta[0]);
+	if (!status) {
+	  return Result<FileSystem>::Fail(status);
+	}
+	meta[0] = util::MetaTable(CURRENT_VERSION);
   } else if (meta.empty()) {
 	meta.emplace_back(CURRENT_VERSION);
 
@@ -81,8 +198,13 @@ Result<FileSystem> FileSystem::Open(sqlite::Database &&database) noexcept {
 	  return Result<FileSystem>::Fail(status);
 	}
 
-	// Create data table
-	if (!(status = database(meta[0].Format(SQL_CREATE_DATA)))) {
+	// Create the data table, the table of shared chunks, and the trigger releasing them
+	status = database(meta[0].Format(SQL_CREATE_CONTENT))
+		.Than([&]() { return database(meta[0].Format(SQL_CREATE_DATA)); })
+		.Than([&]() { return database(meta[0].Format(SQL_CREATE_RELEASE)); })
+		.Than([&]() { return database(meta[0].Format(SQL_CREATE_OFFSETS)); })
+		.Than([&]() { return database(meta[0].Format(SQL_CREATE_CHILDREN)); });
+	if (!status) {
 	  return Result<FileSystem>::Fail(status);
 	}
   }
@@ -91,19 +213,51 @@ Result<FileSystem> FileSystem::Open(sqlite::Database &&database) noexcept {
   auto handle_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_GET_HANDLE));
   auto chunk_statement = util::Reader::PrepareStatement(database, meta[0]);
   auto insert_header_statement =
-	  sqlite::PreparedStatement::Insert(database, meta[0].Meta(), {"path", "type", "chunk_size"});
+	  sqlite::PreparedStatement::Insert(database,
+										meta[0].Meta(),
+										{"path", "type", "flags", "chunk_size", "size", "chunks", "last_chunk_size", "parent"});
   auto insert_blob_statement =
-	  sqlite::PreparedStatement::Insert(database, meta[0].Data(), {"file_id", "chunk_num", "data"});
+	  sqlite::PreparedStatement::Insert(database, meta[0].Data(), {"file_id", "chunk_num", "chunk_offset", "data"});
   auto glob_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_GLOB));
   auto size_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_SIZE));
   auto delete_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_DELETE));
+  auto stream_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_STREAM));
+  auto reference_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_INSERT_REFERENCE));
+  auto layout_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_UPDATE_LAYOUT));
+  auto dimension_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_GET_LAYOUT));
+  auto resize_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_RESIZE));
+  auto remove_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_REMOVE_CHUNKS));
+  auto stamp_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_STAMP));
+  auto stat_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_STAT));
+  auto list_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_LIST));
+  auto move_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_MOVE));
+  auto rename_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_RENAME));
+  auto copy_header_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_COPY_HEADER));
+  auto copy_chunks_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_COPY_CHUNKS));
+  auto share_statement = sqlite::PreparedStatement::Create(database, meta[0].Format(SQL_SHARE));
+  auto content_store = util::ContentStore::Prepare(database, meta[0]);
 
   Status status = sqlite::Result<>::Check(handle_statement,
 										  chunk_statement,
 										  insert_header_statement,
 										  insert_blob_statement,
 										  glob_statement,
-										  size_statement);
+										  size_statement,
+										  stream_statement,
+										  reference_statement,
+										  layout_statement,
+										  dimension_statement,
+										  resize_statement,
+										  remove_statement,
+										  stamp_statement,
+										  stat_statement,
+										  list_statement,
+										  move_statement,
+										  rename_statement,
+										  copy_header_statement,
+										  copy_chunks_statement,
+										  share_statement,
+										  content_store);
   if (status) {
 	// Protected constructor enforce external setup
 	return Result<FileSystem>(FileSystem(std::move(database),
@@ -114,15 +268,96 @@ Result<FileSystem> FileSystem::Open(sqlite::Database &&database) noexcept {
 										 sqlite::Result<>::Get(std::move(glob_statement)),
 										 sqlite::Result<>::Get(std::move(size_statement)),
 										 sqlite::Result<>::Get(std::move(delete_statement)),
+										 sqlite::Result<>::Get(std::move(stream_statement)),
+										 sqlite::Result<>::Get(std::move(reference_statement)),
+										 sqlite::Result<>::Get(std::move(layout_statement)),
+										 sqlite::Result<>::Get(std::move(dimension_statement)),
+										 sqlite::Result<>::Get(std::move(resize_statement)),
+										 sqlite::Result<>::Get(std::move(remove_statement)),
+										 sqlite::Result<>::Get(std::move(stamp_statement)),
+										 sqlite::Result<>::Get(std::move(stat_statement)),
+										 sqlite::Result<>::Get(std::move(list_statement)),
+										 sqlite::Result<>::Get(std::move(move_statement)),
+										 sqlite::Result<>::Get(std::move(rename_statement)),
+										 sqlite::Result<>::Get(std::move(copy_header_statement)),
+										 sqlite::Result<>::Get(std::move(copy_chunks_statement)),
+										 sqlite::Result<>::Get(std::move(share_statement)),
+										 sqlite::Result<>::Get(std::move(content_store)),
 										 meta[0]));
   } else {
 	return Result<FileSystem>::Fail(status);
   }
 }
 
+sqlite::Status FileSystem::Migrate(sqlite::Database &database, const util::MetaTable &meta) noexcept {
+  // The statements upgrading version i to version i + 1, where {meta} refers to the new table.
+  static const std::vector<std::string_view> MIGRATIONS[CURRENT_VERSION] = {
+	  {
+		  "ALTER TABLE {meta} ADD COLUMN size INTEGER NOT NULL DEFAULT 0",
+		  "ALTER TABLE {meta} ADD COLUMN chunks INTEGER NOT NULL DEFAULT 0",
+		  "ALTER TABLE {meta} ADD COLUMN last_chunk_size INTEGER NOT NULL DEFAULT 0",
+		  R"(UPDATE {meta} SET
+			size = (SELECT COALESCE(SUM(LENGTH(data)), 0) FROM {data} WHERE file_id = {meta}.id),
+			chunks = (SELECT COUNT(*) FROM {data} WHERE file_id = {meta}.id),
+			last_chunk_size = COALESCE((SELECT LENGTH(data) FROM {data} WHERE file_id = {meta}.id ORDER BY chunk_num DESC LIMIT 1), 0)
+		  )"
+	  },
+	  {
+		  "CREATE TABLE IF NOT EXISTS {content} (content_id INTEGER PRIMARY KEY, hash BLOB UNIQUE NOT NULL, refs INTEGER NOT NULL, data BLOB NOT NULL)",
+		  "ALTER TABLE {data} ADD COLUMN content_id INTEGER REFERENCES {content} (content_id)",
+		  R"(CREATE TRIGGER IF NOT EXISTS Matryoshka_Release AFTER DELETE ON {data} WHEN old.content_id IS NOT NULL
+			BEGIN
+			  UPDATE {content} SET refs = refs - 1 WHERE content_id = old.content_id;
+			  DELETE FROM {content} WHERE content_id = old.content_id AND refs <= 0;
+			END
+		  )"
+	  },
+	  {
+		  "ALTER TABLE {data} ADD COLUMN chunk_offset INTEGER",
+		  "CREATE INDEX IF NOT EXISTS Matryoshka_Offsets ON {data} (file_id, chunk_offset) WHERE chunk_offset IS NOT NULL"
+	  },
+	  {
+		  "ALTER TABLE {meta} ADD COLUMN hash BLOB",
+		  "ALTER TABLE {meta} ADD COLUMN modified INTEGER"
+	  },
+	  {
+		  "ALTER TABLE {meta} ADD COLUMN parent INTEGER REFERENCES {meta} (id) ON DELETE CASCADE",
+		  "CREATE INDEX IF NOT EXISTS Matryoshka_Children ON {meta} (parent, path)",
+		  // Create the folders implied by the paths
+		  R"(WITH RECURSIVE folders(path, rest) AS (
+			SELECT substr(path, 1, instr(path, '/') - 1), substr(path, instr(path, '/') + 1) FROM {meta} WHERE instr(path, '/') > 0
+			UNION
+			SELECT path || '/' || substr(rest, 1, instr(rest, '/') - 1), substr(rest, instr(rest, '/') + 1) FROM folders WHERE instr(rest, '/') > 0
+		  )
+		  INSERT OR IGNORE INTO {meta} (path, type, flags, chunk_size) SELECT DISTINCT path, 0, 0, 0 FROM folders)",
+		  // The parent path is the path without the characters behind its last separator
+		  R"(UPDATE {meta} SET parent = (
+			SELECT folder.id FROM {meta} AS folder WHERE folder.type = 0 AND folder.path = rtrim(rtrim({meta}.path, replace({meta}.path, '/', '')), '/')
+		  ))"
+	  }
+  };
+
+  auto transaction = Transaction::Open(&database);
+  if (!transaction) {
+	return static_cast<Status>(transaction);
+  }
+
+  Status status;
+  for (auto version = meta.Id(); version < CURRENT_VERSION && status; ++version) {
+	// Renaming the meta table keeps the foreign keys of the data table intact
+	const util::MetaTable current(version), next(version + 1);
+	status = current.Rename(database, next);
+	for (auto statement = MIGRATIONS[version].begin(); statement != MIGRATIONS[version].end() && status; ++statement) {
+	  status = database(next.Format(*statement));
+	}
+  }
+
+  return status ? transaction->Commit() : status;
+}
+
 Result<File> FileSystem::Open(const Path &path) noexcept {
   const std::string clean_path = path.AbsolutePath();
-  std::optional<int> handle = handle_statement_.Execute<int, std::string_view, int>(
+  std::optional<sqlite::Database::RowId> handle = handle_statement_.Execute<sqlite::Database::RowId, std::string_view, int>(
 	  clean_path,
 	  static_cast<int>(File::Type)
   );
@@ -134,9 +369,23 @@ Result<File> FileSystem::Open(const Path &path) noexcept {
   }
 }
 
-Result<FileSystem::Chunk> FileSystem::Read(const File &file, int start, int length) const {
+Result<Folder> FileSystem::OpenFolder(const Path &path) noexcept {
+  const std::string clean_path = path.AbsolutePath();
+  std::optional<sqlite::Database::RowId> handle = handle_statement_.Execute<sqlite::Database::RowId, std::string_view, int>(
+	  clean_path,
+	  static_cast<int>(Folder::Type)
+  );
+
+  if (handle.has_value()) {
+	return Result<Folder>::Ok(handle.value());
+  } else {
+	return Result<Folder>::Fail(errors::Io::FileNotFound);
+  }
+}
+
+Result<FileSystem::Chunk> FileSystem::Read(const File &file, SizeType start, SizeType length) const {
   util::ContinuousReader reader(length, start);
-  auto error = this->Read(file, &reader, start);
+  auto error = this->Read(file, reader, start);
   if (!error) {
 	return Result<FileSystem::Chunk>::Ok(util::ContinuousReader::Release(std::move(reader)));
   } else {
@@ -145,15 +394,15 @@ Result<FileSystem::Chunk> FileSystem::Read(const File &file, int start, int leng
 }
 
 std::optional<Error> FileSystem::Read(const File &file,
-									  int start,
-									  int length,
+									  SizeType start,
+									  SizeType length,
 									  std::function<bool(Chunk &&)> callback) const {
   util::ChunkReader reader(length, [&](auto &&chunk) {
 	return callback(std::forward<decltype(chunk)>(chunk)) ? Status() : Status::Aborted();
   }, start);
 
   // Read the chunks. Aborting by user is not a error worth reporting.
-  auto error = this->Read(file, &reader, start);
+  auto error = this->Read(file, reader, start);
   if (!error || error.value() == Error(Status::Aborted())) {
 	return std::nullopt;
   } else {
@@ -162,11 +411,34 @@ std::optional<Error> FileSystem::Read(const File &file,
 
 }
 
+std::optional<Error> FileSystem::Read(const File &file,
+									  SizeType start,
+									  const Buffer *buffers,
+									  std::size_t num_buffers) const {
+  util::BufferReader reader(buffers, num_buffers, start);
+  if (reader.Length() <= 0) {
+	return std::nullopt;
+  }
+  return this->Read(file, reader, start);
+}
+
 Result<File> FileSystem::Create(const Path &path,
-								std::function<sqlite::Status(sqlite::Database::RowId, int)> file_creation,
-								int file_size,
-								int chunk_size) {
-  // Define a appropriate chunk size
+								std::function<sqlite::Status(sqlite::Database::RowId, int, int)> file_creation,
+								const std::function<util::Sha256::Digest()> &digest,
+								SizeType file_size,
+								int proposed_chunk_size) {
+  // The root is always a folder
+  if (!path) {
+	return Result<File>::Fail(Error(errors::ArgumentError()));
+  }
+
+  // Content-defined chunks are bound by their maximal size
+  if (options_.content_defined_chunking.has_value()) {
+	proposed_chunk_size = options_.content_defined_chunking->maximal_size;
+  }
+
+  // Define a appropriate chunk size. A single chunk is bound by the SQLite limits, the file is not.
+  SizeType chunk_size = proposed_chunk_size;
   if (chunk_size <= 0 || chunk_size > file_size) {
 	chunk_size = file_size;
   }
@@ -181,7 +453,10 @@ Result<File> FileSystem::Create(const Path &path,
   }
 
   // Create the header entry and get the file handle
-  auto header_container = this->CreateHeader(path, chunk_size, File::Type);
+  const int flags = (options_.deduplicate ? FLAG_DEDUPLICATED : 0)
+	  | (options_.content_defined_chunking.has_value() ? FLAG_CONTENT_DEFINED : 0)
+	  | util::Codec::ToFlags(options_.codec);
+  auto header_container = this->CreateHeader(path, static_cast<int>(chunk_size), File::Type, file_size, flags);
   if (!header_container) {
 	auto status = static_cast<Status>(header_container);
 	if (status.ConstraintViolated()) {
@@ -193,7 +468,14 @@ Result<File> FileSystem::Create(const Path &path,
 
   // Create the actual file and fail if that was not sucessfull
   auto file = std::get<sqlite::Database::RowId>(header_container);
-  const Status status = file_creation(file, chunk_size);
+  Status status = file_creation(file, static_cast<int>(chunk_size), flags);
+  if (status && (flags & FLAG_CONTENT_DEFINED) != 0) {
+	// The number of chunks is known only after writing them
+	status = layout_statement_.Execute(file);
+  }
+  if (status) {
+	status = this->Stamp(file, digest());
+  }
   if (!status) {
 	return Result<File>::Fail(status);
   }
@@ -201,52 +483,97 @@ Result<File> FileSystem::Create(const Path &path,
   // Ensure data is correctly written into the database
   const Status is_commit_succesful = transaction->Commit();
   if (!is_commit_succesful) {
-	return Result<File>::Fail(status);
+	return Result<File>::Fail(is_commit_succesful);
   }
 
   return Result<File>::Ok(file);
 }
 
 Result<File> FileSystem::Create(const Path &path, FileSystem::Chunk &&data, int proposed_chunk_size) {
-  return this->Create(path, [&](sqlite::Database::RowId file_id, int chunk_size) {
-	// Write the data to SQlite, most efficiently if it is only a single chunk
-	Status status;
-	if (chunk_size == data.Size()) {
-	  status = blob_statement_([&](Query &query) {
-		return query.Set(0, file_id)
-			.Than([&]() {
-			  return query.Set(1, 0);
-			}).Than([&]() {
-			  return query.Set(2, std::move(data));
-			}).Than(query);
-	  });
-	} else {
-	  for (int part_index = 0, c = 0, size = data.Size(); part_index < size && status; part_index += chunk_size, ++c) {
-		status = blob_statement_([&](Query &query) {
-		  return query.Set(0, file_id)
-			  .Than([&]() {
-				return query.Set(1, c);
-			  }).Than([&]() {
-				return query.Set(2, data.Part(std::min(chunk_size, size - part_index), part_index));
-			  }).Than(query);
-		});
+  const auto digest = util::Sha256::Hash(data);
+  return this->Create(path, std::move(data), digest, proposed_chunk_size);
+}
+
+Result<File> FileSystem::Create(const Path &path,
+								FileSystem::Chunk &&data,
+								const util::Sha256::Digest &digest,
+								int proposed_chunk_size) {
+  const SizeType file_size = data.Size();
+  return this->Create(path, [&](sqlite::Database::RowId file_id, int chunk_size, int flags) {
+	return this->WriteChunks(file_id, 0, 0, std::move(data), chunk_size, flags);
+  }, [&digest]() {
+	return digest;
+  }, file_size, proposed_chunk_size);
+}
+
+template<bool HasOwnership>
+sqlite::Status FileSystem::WriteChunks(sqlite::Database::RowId file_id,
+									   std::int_fast64_t chunk_num,
+									   SizeType offset,
+									   sqlite::Blob<HasOwnership> &&data,
+									   int chunk_size,
+									   int flags) {
+  // Write the data to SQlite, most efficiently if it is only a single chunk
+  Status status;
+  const SizeType size = data.Size();
+  if ((flags & FLAG_CONTENT_DEFINED) != 0) {
+	util::Chunker chunker(this->ChunkerParameters(chunk_size));
+	for (SizeType part_index = 0, part_size = 0; part_index < size && status; part_index += part_size, ++chunk_num) {
+	  part_size = chunker.Update(data.Data() + part_index, size - part_index);
+	  if (part_size < 0) {
+		part_size = size - part_index;
 	  }
+	  status = this->WriteChunk(file_id, chunk_num, offset + part_index, data.Part(part_size, part_index), flags);
 	}
-	return status;
-  }, data.Size(), proposed_chunk_size);
+  } else if (chunk_size == size) {
+	status = this->WriteChunk(file_id, chunk_num, offset, std::move(data), flags);
+  } else {
+	for (SizeType part_index = 0; part_index < size && status; part_index += chunk_size, ++chunk_num) {
+	  status = this->WriteChunk(file_id,
+								chunk_num,
+								offset + part_index,
+								data.Part(std::min<SizeType>(chunk_size, size - part_index), part_index),
+								flags);
+	}
+  }
+  return status;
+}
+
+util::Chunker::Parameters FileSystem::ChunkerParameters(int maximal_size) const noexcept {
+  // The parameters are not stored alongside a file, so derive them from its maximal chunk size if required
+  if (options_.content_defined_chunking.has_value()) {
+	return options_.content_defined_chunking.value();
+  }
+  return util::Chunker::Parameters::Create(std::max(maximal_size / 8, 64));
 }
 
 Result<File> FileSystem::Create(const Path &path,
-								std::function<Chunk(int)> data_source,
-								int file_size,
+								std::function<Chunk(int)> source,
+								SizeType file_size,
 								int proposed_chunk_size) {
-  return this->Create(path, [&](sqlite::Database::RowId file_id, int chunk_size) {
+  // The content is hashed on its way into the database
+  util::Sha256 hash;
+  std::function<Chunk(int)> data_source = [&](int size) {
+	auto chunk = source(size);
+	hash.Update(chunk.Data(), chunk.Size());
+	return chunk;
+  };
+
+  return this->Create(path, [&](sqlite::Database::RowId file_id, int chunk_size, int flags) {
+	// Chunks neither shared nor encoded do not need to be kept in memory as a whole
+	if ((flags & FLAG_CONTENT_DEFINED) != 0) {
+	  return this->WriteContentDefined(file_id, data_source, file_size, flags);
+	} else if (flags == 0 && options_.buffer_size > 0 && chunk_size > options_.buffer_size) {
+	  return this->WriteStreamed(file_id, data_source, file_size, chunk_size);
+	}
+
 	util::Cache cache;
-	int bytes_written = 0, chunk_num = 0;
+	SizeType bytes_written = 0;
+	std::int_fast64_t chunk_num = 0;
 	Status result = Status();
 
 	while (result && bytes_written < file_size) {
-	  const int required_bytes = std::min(chunk_size, file_size - bytes_written);
+	  const int required_bytes = static_cast<int>(std::min<SizeType>(chunk_size, file_size - bytes_written));
 	  auto chunk = data_source(required_bytes);
 
 	  // Callback might be aborted at any time
@@ -256,15 +583,8 @@ Result<File> FileSystem::Create(const Path &path,
 	  }
 
 	  // The optimal case: No data cached, new chunk of optimal size -> no copy involved
-	  if (chunk.size() == required_bytes && !cache) {
-		result = blob_statement_([&](Query &query) {
-		  return query.Set(0, file_id)
-			  .Than([&]() {
-				return query.Set(1, chunk_num++);
-			  }).Than([&]() {
-				return query.Set(2, std::move(chunk));
-			  }).Than(query);
-		});
+	  if (chunk.size() == static_cast<std::size_t>(required_bytes) && !cache) {
+		result = this->WriteChunk(file_id, chunk_num++, bytes_written, std::move(chunk), flags);
 		bytes_written += required_bytes;
 		continue;
 	  }
@@ -272,67 +592,205 @@ Result<File> FileSystem::Create(const Path &path,
 	  // Place the chunk on the cache and use it
 	  cache.Push(std::move(chunk));
 	  if (cache.Size() >= required_bytes) {
-		result = blob_statement_([&](Query &query) {
-		  return query.Set(0, file_id)
-			  .Than([&]() {
-				return query.Set(1, chunk_num++);
-			  }).Than([&]() {
-				return query.Set(2, cache.Pop(required_bytes));
-			  }).Than(query);
-		});
+		result = this->WriteChunk(file_id, chunk_num++, bytes_written, cache.Pop(required_bytes), flags);
 		bytes_written += required_bytes;
 	  }
 	}
 
 	return result;
+  }, [&hash]() {
+	return hash.Finish();
   }, file_size, proposed_chunk_size);
 }
 
-Result<File> FileSystem::Create(const Path &path, std::string_view file_path, int chunk_size) {
-  std::ifstream file(file_path.data(), std::ifstream::in | std::ifstream::binary);
-  if (file) {
-	// Get file length
-	file.seekg(0, std::ifstream::end);
-	const int length = file.tellg();
-	file.seekg(0, std::ifstream::beg);
-	if (!file) {
-	  return Result<File>::Fail(errors::Io::ReadingError);
+sqlite::Status FileSystem::WriteContentDefined(sqlite::Database::RowId file_id,
+											   std::function<Chunk(int)> &data_source,
+											   SizeType file_size,
+											   int flags) {
+  util::Cache cache;
+  util::Chunker chunker(this->ChunkerParameters(0));
+  const int maximal_size = chunker.MaximalSize();
+  SizeType bytes_read = 0, bytes_written = 0;
+  std::int_fast64_t chunk_num = 0;
+  Status result = Status();
+
+  while (result && bytes_written < file_size) {
+	// Keep at least a chunk of maximal size in the cache, so the next boundary is always found
+	if (cache.Size() < maximal_size && bytes_read < file_size) {
+	  auto chunk = data_source(static_cast<int>(std::min<SizeType>(maximal_size, file_size - bytes_read)));
+	  if (!chunk) {
+		result = Status::Aborted();
+		break;
+	  }
+	  bytes_read += chunk.Size();
+	  cache.Push(std::move(chunk));
+	  continue;
 	}
 
-	// Copy the file chunkwise into the buffer
-	auto result = this->Create(path, [&](int chunk_size) {
-	  Chunk data(chunk_size);
-	  file.read(reinterpret_cast<char *>(data.Data()), chunk_size);
-	  if (file.gcount() == chunk_size) {
-		return data;
-	  } else {
-		return Chunk();
+	// Only the end of the file is not terminated by a boundary
+	SizeType chunk_size = cache.Find(chunker);
+	if (chunk_size <= 0) {
+	  chunk_size = cache.Size();
+	  chunker.Reset();
+	}
+	result = this->WriteChunk(file_id, chunk_num++, bytes_written, cache.Pop(chunk_size), flags);
+	bytes_written += chunk_size;
+  }
+
+  return result;
+}
+
+sqlite::Status FileSystem::WriteStreamed(sqlite::Database::RowId file_id,
+										 std::function<Chunk(int)> &data_source,
+										 SizeType file_size,
+										 int chunk_size) {
+  util::Cache cache;
+  return this->WriteStreamed(file_id, [&](BlobWriter &writer, int chunk_offset, SizeType file_offset, int length) {
+	Status result = Status();
+	for (int piece_offset = 0; result && piece_offset < length;) {
+	  if (!cache) {
+		auto piece = data_source(static_cast<int>(std::min<SizeType>(options_.buffer_size,
+																	 file_size - file_offset - piece_offset)));
+		if (!piece) {
+		  return Status::Aborted();
+		}
+		cache.Push(std::move(piece));
+	  }
+
+	  const auto piece = cache.Pop(std::min<SizeType>(cache.Size(), length - piece_offset));
+	  result = writer.Write(piece.Data(), chunk_offset + piece_offset, static_cast<int>(piece.Size()));
+	  piece_offset += static_cast<int>(piece.Size());
+	}
+	return result;
+  }, file_size, chunk_size);
+}
+
+sqlite::Status FileSystem::WriteStreamed(sqlite::Database::RowId file_id,
+										 const std::function<Status(BlobWriter &, int, SizeType, int)> &fill,
+										 SizeType file_size,
+										 int chunk_size) {
+  std::optional<BlobWriter> writer;
+  SizeType bytes_written = 0;
+  Status result = Status();
+
+  for (std::int_fast64_t chunk_num = 0; result && bytes_written < file_size; ++chunk_num) {
+	// Allocate the chunk in the database without providing its content
+	const int required_bytes = static_cast<int>(std::min<SizeType>(chunk_size, file_size - bytes_written));
+	result = blob_statement_([&](Query &query) {
+	  return query.Set(0, file_id)
+		  .Than([&]() {
+			return query.Set(1, chunk_num);
+		  }).Than([&]() {
+			return query.Unset(2);
+		  }).Than([&]() {
+			return query.SetZeroBlob(3, required_bytes);
+		  }).Than(query);
+	});
+	if (!result) {
+	  break;
+	}
+
+	// Reuse the handle of the previous chunk, if available
+	auto blob = writer.has_value()
+				? BlobWriter::Open(std::move(writer.value()), database_.LastInsertedRow())
+				: BlobWriter::Open(database_, database_.LastInsertedRow(), meta_.Data(), "data");
+	writer.reset();
+	if (!blob) {
+	  return static_cast<Status>(blob);
+	}
+	writer.emplace(sqlite::Result<>::Get(std::move(blob)));
+
+	// Fill the chunk with pieces no larger than the buffer
+	for (int chunk_offset = 0; result && chunk_offset < required_bytes;) {
+	  const int length = static_cast<int>(std::min<SizeType>(options_.buffer_size, required_bytes - chunk_offset));
+	  result = fill(writer.value(), chunk_offset, bytes_written + chunk_offset, length);
+	  chunk_offset += length;
+	}
+	bytes_written += required_bytes;
+  }
+
+  return result;
+}
+
+Result<File> FileSystem::Create(const Path &path, std::string_view file_path, int chunk_size) {
+  auto opened = util::InputFile::Open(file_path);
+  if (!opened) {
+	return Result<File>::Fail(std::move(std::get<Error>(opened)));
+  }
+  const auto &file = std::get<util::InputFile>(opened);
+  const auto mapping = file.Mapping();
+  const SizeType length = file.Size();
+
+  // Chunks are bound as slices of the mapping, so the file is neither copied into buffers nor held in memory
+  auto create_mapped = [&]() {
+	return this->Create(path, [&](sqlite::Database::RowId file_id, int chunk_size, int flags) {
+	  if (flags == 0 && options_.buffer_size > 0 && chunk_size > options_.buffer_size) {
+		return this->WriteStreamed(file_id, [&](BlobWriter &writer, int chunk_offset, SizeType offset, int num_bytes) {
+		  return writer.Write(mapping->Data() + offset, chunk_offset, num_bytes);
+		}, length, chunk_size);
 	  }
+	  return this->WriteChunks(file_id, 0, 0, sqlite::Blob<false>(mapping.value()), chunk_size, flags);
+	}, [&mapping]() {
+	  return util::Sha256::Hash(mapping.value());
 	}, length, chunk_size);
+  };
 
-	// Check if file was read successfully
-	Error *error = nullptr;
-	if ((error = std::get_if<Error>(&result)) != nullptr) {
-	  Status *code = nullptr;
-	  if ((code = error->get<Status>()) != nullptr && *code == Status::Aborted()) {
-		return Result<File>::Fail(errors::Io::ReadingError);
+  // Files which cannot be mapped are copied chunkwise into the buffer
+  auto create_copied = [&]() {
+	SizeType offset = 0;
+	return this->Create(path, [&](int num_bytes) {
+	  Chunk data(num_bytes);
+	  if (file.Read(offset, data.Data(), num_bytes).has_value()) {
+		return Chunk();
 	  }
-	}
+	  offset += num_bytes;
+	  return data;
+	}, length, chunk_size);
+  };
 
-	return result;
-  } else {
-	return Result<File>::Fail(errors::Io::FileNotFound);
+  auto result = mapping.has_value() ? create_mapped() : create_copied();
+
+  // Check if file was read successfully
+  Error *error = nullptr;
+  if ((error = std::get_if<Error>(&result)) != nullptr) {
+	Status *code = nullptr;
+	if ((code = error->get<Status>()) != nullptr && *code == Status::Aborted()) {
+	  return Result<File>::Fail(errors::Io::ReadingError);
+	}
   }
+  return result;
 }
 
 sqlite::Result<sqlite::Database::RowId, sqlite::Status> FileSystem::CreateHeader(const Path &path,
 																				 int chunk_size,
-																				 FileSystemObjectType type) noexcept {
+																				 FileSystemObjectType type,
+																				 SizeType file_size,
+																				 int flags) noexcept {
+  if (!path) {
+	return sqlite::Result<sqlite::Database::RowId, sqlite::Status>::Fail(Status(SQLITE_MISUSE));
+  }
+
+  // The chunk layout is stored alongside the header, so the size is available without touching the data
+  const std::int_fast64_t num_chunks = chunk_size > 0 ? (file_size + chunk_size - 1) / chunk_size : 0;
+  const int last_chunk_size = num_chunks > 0 ? static_cast<int>(file_size - (num_chunks - 1) * chunk_size) : 0;
+
+  // Each entry refers to its folder, which is created on demand
+  auto parent = this->RequireFolder(path.Parent());
+  if (!parent) {
+	return sqlite::Result<sqlite::Database::RowId, sqlite::Status>::Fail(static_cast<Status>(parent));
+  }
+  const auto &parent_id = std::get<std::optional<sqlite::Database::RowId>>(parent);
+
   sqlite::Database::RowId id = -1;
   const Status status = header_statement_([&](Query &query) {
 	return query.Set(0, path.AbsolutePath())
 		.Than([&]() { return query.Set(1, static_cast<int>(type)); })
-		.Than([&]() { return query.Set(2, chunk_size); })
+		.Than([&]() { return query.Set(2, flags); })
+		.Than([&]() { return query.Set(3, chunk_size); })
+		.Than([&]() { return query.Set(4, file_size); })
+		.Than([&]() { return query.Set(5, num_chunks); })
+		.Than([&]() { return query.Set(6, last_chunk_size); })
+		.Than([&]() { return parent_id.has_value() ? query.Set(7, parent_id.value()) : query.Unset(7); })
 		.Than(query)
 		.Than([&]() {
 		  id = database_.LastInsertedRow();
@@ -347,6 +805,28 @@ sqlite::Result<sqlite::Database::RowId, sqlite::Status> FileSystem::CreateHeader
   }
 }
 
+sqlite::Result<std::optional<sqlite::Database::RowId>, sqlite::Status> FileSystem::RequireFolder(const Path &path) noexcept {
+  using FolderResult = sqlite::Result<std::optional<sqlite::Database::RowId>, sqlite::Status>;
+  if (!path) {
+	return FolderResult::Ok(std::nullopt);
+  }
+
+  // Existing folders are found with a single lookup, missing ones create their parents recursively
+  const std::string clean_path = path.AbsolutePath();
+  auto handle = handle_statement_.Execute<sqlite::Database::RowId, std::string_view, int>(clean_path,
+																						   static_cast<int>(Folder::Type));
+  if (handle.has_value()) {
+	return FolderResult::Ok(handle);
+  }
+  auto header = this->CreateHeader(path, 0, Folder::Type, 0);
+  if (!header) {
+	return FolderResult::Fail(static_cast<Status>(header));
+  }
+  const auto id = std::get<sqlite::Database::RowId>(header);
+  const Status status = this->Stamp(id, std::nullopt);
+  return status ? FolderResult::Ok(id) : FolderResult::Fail(status);
+}
+
 void FileSystem::Find(const Path &path, std::vector<Path> &files) const noexcept {
   std::string full_path = path.AbsolutePath();
   glob_statement_([&](Query &query) {
@@ -359,60 +839,794 @@ void FileSystem::Find(const Path &path, std::vector<Path> &files) const noexcept
   });
 }
 
-int FileSystem::Size(const File &file) {
-  return size_statement_.Execute<int>(file.Handle()).value();
+FileSystem::SizeType FileSystem::Size(const File &file) {
+  return size_statement_.Execute<SizeType, sqlite::Database::RowId>(file.Handle()).value_or(0);
+}
+
+Result<FileStream> FileSystem::Stream(const File &file) const {
+  std::vector<sqlite::Database::RowId> chunks;
+  std::vector<SizeType> offsets;
+  int chunk_size = 0, flags = 0;
+  SizeType size = 0;
+  const Status status = stream_statement_([&](Query &query) {
+	Status result = query.Set(0, file.Handle());
+	while (result && (result = query()).DataAvailable()) {
+	  chunks.emplace_back(query.Get<sqlite::Database::RowId>(0));
+	  chunk_size = query.Get<int>(1);
+	  size = query.Get<SizeType>(2);
+	  flags = query.Get<int>(3);
+	  offsets.emplace_back(query.Get<SizeType>(4));
+	}
+	return result;
+  });
+
+  if (status) {
+	return Result<FileStream>::Ok(FileStream(&database_,
+													 this->BlobTable(flags),
+													 util::Codec::FromFlags(flags),
+													 std::move(chunks),
+													 std::move(offsets),
+													 chunk_size,
+													 size));
+  } else {
+	return Result<FileStream>::Fail(status);
+  }
 }
 
 bool FileSystem::Delete(File &&file) {
+  // Shared chunks are released by a trigger once they are no longer referenced
   return !delete_statement_.Execute<int>(file.Handle()).has_value();
 }
 
-std::optional<Error> FileSystem::Read(const File &file, util::Reader *reader, int start) const {
+bool FileSystem::Delete(Folder &&folder) {
+  // The content is deleted by cascading along the parent references
+  return !delete_statement_.Execute<int>(folder.Handle()).has_value();
+}
+
+Result<Folder> FileSystem::CreateFolder(const Path &path) {
+  if (!path) {
+	return Result<Folder>::Fail(Error(errors::ArgumentError()));
+  }
+
+  auto transaction = Transaction::Open(&database_);
+  if (!transaction) {
+	return Result<Folder>::Fail(static_cast<Status>(transaction));
+  }
+  auto folder = this->RequireFolder(path);
+  if (!folder) {
+	return Result<Folder>::Fail(static_cast<Status>(folder));
+  }
+  const Status status = transaction->Commit();
+  if (!status) {
+	return Result<Folder>::Fail(status);
+  }
+  return Result<Folder>::Ok(std::get<std::optional<sqlite::Database::RowId>>(folder).value());
+}
+
+std::optional<Error> FileSystem::Write(const File &file, SizeType offset, const sqlite::BlobBase &data) {
+  auto transaction = Transaction::Open(&database_);
+  if (!transaction) {
+	return Error(static_cast<Status>(transaction));
+  }
+
+  auto header = this->QueryLayout(file);
+  if (!header) {
+	return std::get<Error>(header);
+  }
+  const Layout &layout = std::get<Layout>(header);
+  if (offset < 0 || offset > layout.size) {
+	return Error(errors::Io::OutOfBounds);
+  }
+
+  // Overwrite the existing bytes and append the remaining ones
+  const SizeType overlap = std::min<SizeType>(data.Size(), layout.size - offset);
+  const Status status = this->Overwrite(file, layout, offset, Blob<false>(data.Data(), overlap))
+	  .Than([&]() {
+		return this->Extend(file, layout, Blob<false>(data.Data() + overlap, data.Size() - overlap));
+	  }).Than([&]() {
+	    return this->Stamp(file.Handle(), std::nullopt);
+	  }).Than([&]() {
+	    return transaction->Commit();
+	  });
+  return status ? std::nullopt : std::optional<Error>(status);
+}
+
+std::optional<Error> FileSystem::Append(const File &file, const sqlite::BlobBase &data) {
+  auto transaction = Transaction::Open(&database_);
+  if (!transaction) {
+	return Error(static_cast<Status>(transaction));
+  }
+
+  auto header = this->QueryLayout(file);
+  if (!header) {
+	return std::get<Error>(header);
+  }
+  const Layout &layout = std::get<Layout>(header);
+
+  const Status status = this->Extend(file, layout, data).Than([&]() {
+	return this->Stamp(file.Handle(), std::nullopt);
+  }).Than([&]() {
+	return transaction->Commit();
+  });
+  return status ? std::nullopt : std::optional<Error>(status);
+}
+
+std::optional<Error> FileSystem::Truncate(const File &file, SizeType size) {
+  auto transaction = Transaction::Open(&database_);
+  if (!transaction) {
+	return Error(static_cast<Status>(transaction));
+  }
+
+  auto header = this->QueryLayout(file);
+  if (!header) {
+	return std::get<Error>(header);
+  }
+  const Layout &layout = std::get<Layout>(header);
+  if (size < 0 || size > layout.size) {
+	return Error(errors::Io::OutOfBounds);
+  } else if (size == layout.size) {
+	return std::nullopt;
+  } else if (size == 0) {
+	const Status status = this->RemoveChunks(file, 0, layout.chunks - 1)
+		.Than([&]() {
+		  return this->Resize(file, layout.chunk_size, 0, 0, 0);
+		}).Than([&]() {
+		  return this->Stamp(file.Handle(), std::nullopt);
+		}).Than([&]() {
+		  return transaction->Commit();
+		});
+	return status ? std::nullopt : std::optional<Error>(status);
+  }
+
+  // Find the chunk containing the new end of the file
+  std::vector<Slice> slices;
+  Status status = this->QuerySlices(file, size - 1, 1, slices);
+  if (!status) {
+	return Error(status);
+  } else if (slices.size() != 1) {
+	return Error(errors::Io::OutOfBounds);
+  }
+  const Slice &last = slices.front();
+
+  // Remove the following chunks and cut the last one, if it is not kept completely
+  auto chunk = this->LoadChunk(last.blob_id, layout.flags);
+  if (!chunk) {
+	return Error(static_cast<Status>(chunk));
+  }
+  const SizeType kept = size - last.offset;
+  status = this->RemoveChunks(file, last.chunk_num + 1, layout.chunks - 1);
+  if (status && kept < chunk->Size()) {
+	status = this->RemoveChunks(file, last.chunk_num, last.chunk_num).Than([&]() {
+	  return this->WriteChunk(file.Handle(), last.chunk_num, last.offset, chunk->Part(kept), layout.flags);
+	});
+  }
+
+  status = status.Than([&]() {
+	return this->Resize(file, layout.chunk_size, size, last.chunk_num + 1, static_cast<int>(kept));
+  }).Than([&]() {
+    return this->Stamp(file.Handle(), std::nullopt);
+  }).Than([&]() {
+    return transaction->Commit();
+  });
+  return status ? std::nullopt : std::optional<Error>(status);
+}
+
+Result<FileSystem::Metadata> FileSystem::Stat(const File &file) const {
+  std::optional<Metadata> metadata;
+  const Status status = stat_statement_([&](Query &query) {
+	return query.Set(0, file.Handle()).Than([&]() {
+	  Status result = query();
+	  if (result.DataAvailable()) {
+		metadata = FileSystem::ReadMetadata(query, 0);
+		result = Status();
+	  }
+	  return result;
+	});
+  });
+
+  if (!status) {
+	return Result<Metadata>::Fail(Error(status));
+  } else if (!metadata) {
+	return Result<Metadata>::Fail(Error(errors::Io::FileNotFound));
+  }
+  return Result<Metadata>::Ok(std::move(metadata.value()));
+}
+
+Result<sqlite::Transaction> FileSystem::Begin() {
+  auto transaction = Transaction::Open(&database_);
+  if (!transaction) {
+	return Result<Transaction>::Fail(static_cast<Status>(transaction));
+  }
+  return Result<Transaction>::Ok(std::move(std::get<Transaction>(transaction)));
+}
+
+std::optional<Error> FileSystem::Move(const Path &from, const Path &to) {
+  auto transaction = Transaction::Open(&database_);
+  if (!transaction) {
+	return Error(static_cast<Status>(transaction));
+  }
+  auto source = this->QueryTransfer(from, to);
+  if (!source) {
+	return std::get<Error>(source);
+  }
+  const auto[id, is_folder] = std::get<std::pair<sqlite::Database::RowId, bool>>(source);
+  auto parent = this->RequireFolder(to.Parent());
+  if (!parent) {
+	return Error(static_cast<Status>(parent));
+  }
+  const auto &parent_id = std::get<std::optional<sqlite::Database::RowId>>(parent);
+
+  // The content of a folder keeps referring to it, but the prefix of its paths changes
+  const std::string source_path = from.AbsolutePath(), destination_path = to.AbsolutePath();
+  Status status = move_statement_([&](Query &query) {
+	return query.Set(0, std::string_view(destination_path))
+		.Than([&]() { return parent_id.has_value() ? query.Set(1, parent_id.value()) : query.Unset(1); })
+		.Than([&]() { return query.Set(2, id); })
+		.Than(query);
+  });
+  if (status && is_folder) {
+	status = rename_statement_.Execute(std::string_view(destination_path),
+									   static_cast<int>(source_path.size() + 1),
+									   std::string_view(source_path + '/'),
+									   std::string_view(source_path + '0'));
+  }
+
+  status = status.Than([&]() {
+	return transaction->Commit();
+  });
+  return status ? std::nullopt : std::optional<Error>(status);
+}
+
+std::optional<Error> FileSystem::Copy(const Path &from, const Path &to) {
+  auto transaction = Transaction::Open(&database_);
+  if (!transaction) {
+	return Error(static_cast<Status>(transaction));
+  }
+  auto source = this->QueryTransfer(from, to);
+  if (!source) {
+	return std::get<Error>(source);
+  }
+  const auto[id, is_folder] = std::get<std::pair<sqlite::Database::RowId, bool>>(source);
+  auto parent = this->RequireFolder(to.Parent());
+  if (!parent) {
+	return Error(static_cast<Status>(parent));
+  }
+
+  const Status status = this->Duplicate(id,
+										is_folder,
+										to.AbsolutePath(),
+										std::get<std::optional<sqlite::Database::RowId>>(parent))
+	  .Than([&]() {
+		return transaction->Commit();
+	  });
+  return status ? std::nullopt : std::optional<Error>(status);
+}
+
+FileSystem::BatchWriter FileSystem::Batch(int batch_size, bool isolate_failures) noexcept {
+  return BatchWriter(this, batch_size, isolate_failures);
+}
+
+FileSystem::BatchWriter::BatchWriter(FileSystem *file_system, int batch_size, bool isolate_failures) noexcept
+	: file_system_(file_system), batch_size_(std::max(batch_size, 1)), pending_(0),
+	  isolate_failures_(isolate_failures) {
+  assert(file_system_ != nullptr);
+}
+
+Result<File> FileSystem::BatchWriter::Create(const Path &path, Chunk &&data, int chunk_size) {
+  return this->Add([&]() {
+	return file_system_->Create(path, std::move(data), chunk_size);
+  });
+}
+
+Result<File> FileSystem::BatchWriter::Create(const Path &path,
+											 Chunk &&data,
+											 const util::Sha256::Digest &digest,
+											 int chunk_size) {
+  return this->Add([&]() {
+	return file_system_->Create(path, std::move(data), digest, chunk_size);
+  });
+}
+
+Result<File> FileSystem::BatchWriter::Create(const Path &path, std::string_view file_path, int chunk_size) {
+  return this->Add([&]() {
+	return file_system_->Create(path, file_path, chunk_size);
+  });
+}
+
+Result<File> FileSystem::BatchWriter::Create(const Path &path,
+											 std::function<Chunk(int)> data,
+											 SizeType file_size,
+											 int chunk_size) {
+  return this->Add([&]() {
+	return file_system_->Create(path, std::move(data), file_size, chunk_size);
+  });
+}
+
+Result<File> FileSystem::BatchWriter::Add(const std::function<Result<File>()> &creation) {
+  // The transaction of a batch is opened with its first file. The file itself is written within a savepoint.
+  if (!transaction_.has_value()) {
+	auto transaction = Transaction::Open(&file_system_->database_);
+	if (!transaction) {
+	  return Result<File>::Fail(static_cast<Status>(transaction));
+	}
+	transaction_.emplace(std::move(std::get<Transaction>(transaction)));
+  }
+
+  auto file = creation();
+  if (!file) {
+	if (!isolate_failures_) {
+	  transaction_.reset();
+	  pending_ = 0;
+	}
+	return file;
+  }
+
+  if (++pending_ >= batch_size_) {
+	if (auto error = this->Commit()) {
+	  return Result<File>(std::move(error.value()));
+	}
+  }
+  return file;
+}
+
+std::optional<Error> FileSystem::BatchWriter::Commit() {
+  if (!transaction_.has_value()) {
+	return std::nullopt;
+  }
+
+  // A failed commit leaves the transaction open, which would turn all following batches into savepoints
+  const Status status = transaction_->Commit();
+  if (!status) {
+	transaction_->Rollback();
+  }
+  transaction_.reset();
+  pending_ = 0;
+  return status ? std::nullopt : std::optional<Error>(Error(status));
+}
+
+Result<std::pair<sqlite::Database::RowId, bool>> FileSystem::QueryTransfer(const Path &from, const Path &to) noexcept {
+  using TransferResult = Result<std::pair<sqlite::Database::RowId, bool>>;
+
+  // Neither the root nor a folder into itself can be moved
+  const std::string source_path = from.AbsolutePath(), destination_path = to.AbsolutePath();
+  if (!from || !to || destination_path == source_path || destination_path.rfind(source_path + '/', 0) == 0) {
+	return TransferResult::Fail(Error(errors::ArgumentError()));
+  } else if (this->Open(to) || this->OpenFolder(to)) {
+	return TransferResult::Fail(Error(errors::Io::FileExists));
+  }
+
+  if (auto file = this->Open(from)) {
+	return TransferResult::Ok(std::make_pair(std::get<File>(file).Handle(), false));
+  } else if (auto folder = this->OpenFolder(from)) {
+	return TransferResult::Ok(std::make_pair(std::get<Folder>(folder).Handle(), true));
+  }
+  return TransferResult::Fail(Error(errors::Io::FileNotFound));
+}
+
+sqlite::Status FileSystem::Duplicate(sqlite::Database::RowId id,
+									 bool is_folder,
+									 const std::string &destination,
+									 std::optional<sqlite::Database::RowId> parent) {
+  sqlite::Database::RowId copy_id = -1;
+  Status status = copy_header_statement_([&](Query &query) {
+	return query.Set(0, std::string_view(destination))
+		.Than([&]() { return parent.has_value() ? query.Set(1, parent.value()) : query.Unset(1); })
+		.Than([&]() { return query.Set(2, id); })
+		.Than(query)
+		.Than([&]() {
+		  copy_id = database_.LastInsertedRow();
+		  return Status();
+		});
+  });
+  if (!status) {
+	return status;
+  } else if (!is_folder) {
+	// Shared chunks gain a reference for each chunk of the copy referring to them
+	return share_statement_.Execute(id, id).Than([&]() {
+	  return copy_chunks_statement_.Execute(copy_id, id);
+	});
+  }
+
+  // The children are collected first, as the statement is used again while copying them
+  std::vector<std::tuple<sqlite::Database::RowId, bool, std::string>> children;
+  status = list_statement_([&](Query &query) {
+	Status result = query.Set(0, id);
+	while (result && (result = query()).DataAvailable()) {
+	  const auto path = query.Get<std::string_view>(0);
+	  children.emplace_back(query.Get<sqlite::Database::RowId>(5),
+							query.Get<int>(1) == Folder::Type,
+							path.substr(path.rfind('/') + 1));
+	}
+	return result;
+  });
+  for (auto child = children.begin(); status && child != children.end(); ++child) {
+	status = this->Duplicate(std::get<0>(*child),
+							 std::get<1>(*child),
+							 destination + '/' + std::get<2>(*child),
+							 copy_id);
+  }
+  return status;
+}
+
+Result<std::vector<FileSystem::Entry>> FileSystem::List(const Path &folder) const {
+  // The entries of the root have no parent
+  std::optional<sqlite::Database::RowId> folder_id;
+  if (folder) {
+	const std::string clean_path = folder.AbsolutePath();
+	const Status status = handle_statement_([&](Query &query) {
+	  return query.SetMulti(0, std::string_view(clean_path), static_cast<int>(Folder::Type)).Than(query).Than([&]() {
+		if (query.Type(0) != Query::ValueType::Null) {
+		  folder_id = query.Get<sqlite::Database::RowId>(0);
+		}
+		return Status();
+	  });
+	});
+	if (!status) {
+	  return Result<std::vector<Entry>>::Fail(Error(status));
+	} else if (!folder_id.has_value()) {
+	  return Result<std::vector<Entry>>::Fail(Error(errors::Io::FileNotFound));
+	}
+  }
+
+  std::vector<Entry> entries;
+  const Status status = list_statement_([&](Query &query) {
+	Status result = folder_id.has_value() ? query.Set(0, folder_id.value()) : query.Unset(0);
+	while (result && (result = query()).DataAvailable()) {
+	  const auto path = query.Get<std::string_view>(0);
+	  entries.push_back(Entry{std::string(path.substr(path.rfind('/') + 1)),
+							  query.Get<int>(1) == Folder::Type,
+							  FileSystem::ReadMetadata(query, 2)});
+	}
+	return result;
+  });
+
+  if (!status) {
+	return Result<std::vector<Entry>>::Fail(Error(status));
+  }
+  return Result<std::vector<Entry>>::Ok(std::move(entries));
+}
+
+FileSystem::Metadata FileSystem::ReadMetadata(const sqlite::Query &query, int column) {
+  Metadata metadata{query.Get<SizeType>(column), std::nullopt, std::nullopt};
+  if (query.Type(column + 1) != Query::ValueType::Null) {
+	metadata.modified = query.Get<std::int_fast64_t>(column + 1);
+  }
+  if (query.Type(column + 2) != Query::ValueType::Null) {
+	const auto hash = query.Get<Blob<false>>(column + 2);
+	util::Sha256::Digest digest{};
+	if (hash.Size() == static_cast<SizeType>(digest.size())) {
+	  std::memcpy(digest.data(), hash.Data(), digest.size());
+	  metadata.hash = util::Sha256::ToHex(digest);
+	}
+  }
+  return metadata;
+}
+
+Result<FileSystem::DeduplicationStatistics> FileSystem::Deduplication() const {
+  auto statistics = content_.Summarize();
+  if (statistics) {
+	return Result<DeduplicationStatistics>::Ok(std::get<DeduplicationStatistics>(statistics));
+  } else {
+	return Result<DeduplicationStatistics>::Fail(static_cast<Status>(statistics));
+  }
+}
+
+template<bool HasOwnership>
+sqlite::Status FileSystem::WriteChunk(sqlite::Database::RowId file_id,
+									  std::int_fast64_t chunk_num,
+									  SizeType offset,
+									  sqlite::Blob<HasOwnership> &&data,
+									  int flags) {
+  // Compressed chunks are written in their encoded form like any other chunk
+  const auto codec = util::Codec::FromFlags(flags);
+  if (codec != util::Codec::Type::Store) {
+	return this->WriteChunk(file_id,
+							chunk_num,
+							offset,
+							util::Codec::Encode(codec, data),
+							flags & ~util::Codec::FLAGS_MASK);
+  }
+
+  // The offset of fixed-size chunks is derived from their number
+  auto set_offset = [&](Query &query, int index) {
+	return (flags & FLAG_CONTENT_DEFINED) != 0 ? query.Set(index, offset) : query.Unset(index);
+  };
+
+  if ((flags & FLAG_DEDUPLICATED) == 0) {
+	return blob_statement_([&](Query &query) {
+	  return query.Set(0, file_id)
+		  .Than([&]() {
+			return query.Set(1, chunk_num);
+		  }).Than([&]() {
+			return set_offset(query, 2);
+		  }).Than([&]() {
+			if constexpr (HasOwnership) {
+			  return query.Set(3, std::move(data));
+			} else {
+			  return query.SetView(3, data);
+			}
+		  }).Than(query);
+	});
+  }
+
+  // Deduplicated files only reference the shared chunk
+  auto content_id = content_.Store(database_, std::move(data));
+  if (!content_id) {
+	return static_cast<Status>(content_id);
+  }
+  return reference_statement_([&](Query &query) {
+	return query.Set(0, file_id)
+		.Than([&]() {
+		  return query.Set(1, chunk_num);
+		}).Than([&]() {
+		  return set_offset(query, 2);
+		}).Than([&]() {
+		  return query.Set(3, std::get<sqlite::Database::RowId>(content_id));
+		}).Than(query);
+  });
+}
+
+Result<FileSystem::Layout> FileSystem::QueryLayout(const File &file) const {
+  std::optional<Layout> layout;
+  const Status status = dimension_statement_([&](Query &query) {
+	return query.Set(0, file.Handle()).Than(query).Than([&]() {
+	  if (query.Type(0) != Query::ValueType::Null) {
+		layout = Layout{query.Get<int>(0), query.Get<int>(1), query.Get<SizeType>(2),
+						query.Get<std::int_fast64_t>(3), query.Get<int>(4)};
+	  }
+	  return Status();
+	});
+  });
+
+  if (!status) {
+	return Result<Layout>::Fail(status);
+  } else if (!layout.has_value()) {
+	return Result<Layout>::Fail(errors::Io::FileNotFound);
+  }
+  return Result<Layout>::Ok(layout.value());
+}
+
+sqlite::Status FileSystem::QuerySlices(const File &file,
+									   SizeType start,
+									   SizeType length,
+									   std::vector<Slice> &slices) const {
+  // The chunks are collected first, as modifying the table while iterating over it is undefined.
+  return chunk_statement_([&](Query &query) {
+	Status status = query.SetByName(":handle", file.Handle())
+		.Than([&] {
+		  return query.SetByName(":index", start);
+		}).Than([&] {
+		  return query.SetByName(":size", length);
+		});
+	while (status && (status = query()).DataAvailable()) {
+	  slices.push_back(Slice{query.Get<sqlite::Database::RowId>(0),
+							 query.Get<std::int_fast64_t>(4),
+							 query.Get<SizeType>(2)});
+	}
+	return status;
+  });
+}
+
+sqlite::Result<FileSystem::Chunk, sqlite::Status> FileSystem::LoadChunk(sqlite::Database::RowId blob_id,
+																		int flags) const {
+  auto blob = BlobReader::Open(database_, blob_id, this->BlobTable(flags), "data");
+  if (!blob) {
+	return sqlite::Result<Chunk, Status>::Fail(static_cast<Status>(blob));
+  }
+
+  Chunk chunk;
+  Status status;
+  if (util::Codec::FromFlags(flags) == util::Codec::Type::Store) {
+	chunk = Chunk(blob->Size());
+	status = blob->Read(chunk);
+  } else {
+	status = util::Codec::Decode(std::get<BlobReader>(blob), chunk);
+  }
+  if (!status) {
+	return sqlite::Result<Chunk, Status>::Fail(status);
+  }
+  return sqlite::Result<Chunk, Status>(std::move(chunk));
+}
+
+sqlite::Status FileSystem::RemoveChunks(const File &file,
+										std::int_fast64_t first_chunk_num,
+										std::int_fast64_t last_chunk_num) {
+  // Shared chunks are released by the trigger
+  if (first_chunk_num > last_chunk_num) {
+	return Status();
+  }
+  return remove_statement_.Execute(file.Handle(), first_chunk_num, last_chunk_num);
+}
+
+sqlite::Status FileSystem::Overwrite(const File &file,
+									 const Layout &layout,
+									 SizeType offset,
+									 const sqlite::BlobBase &data) {
+  if (data.Size() <= 0) {
+	return Status();
+  }
+
+  std::vector<Slice> slices;
+  Status status = this->QuerySlices(file, offset, data.Size(), slices);
+  const bool is_plain = (layout.flags & FLAG_DEDUPLICATED) == 0
+	  && util::Codec::FromFlags(layout.flags) == util::Codec::Type::Store;
+  std::optional<BlobWriter> writer;
+  for (auto slice = slices.begin(); slice != slices.end() && status; ++slice) {
+	const SizeType onset = std::max<SizeType>(offset, slice->offset);
+	if (is_plain) {
+	  // Chunks of the same size are patched in place
+	  auto blob = writer.has_value()
+				  ? BlobWriter::Open(std::move(writer.value()), slice->blob_id)
+				  : BlobWriter::Open(database_, slice->blob_id, meta_.Data(), "data");
+	  writer.reset();
+	  if (!blob) {
+		return static_cast<Status>(blob);
+	  }
+	  writer.emplace(sqlite::Result<>::Get(std::move(blob)));
+	  const SizeType end = std::min<SizeType>(offset + data.Size(), slice->offset + writer->Size());
+	  status = writer->Write(data.Data() + (onset - offset),
+							 static_cast<int>(onset - slice->offset),
+							 static_cast<int>(end - onset));
+	} else {
+	  // Shared or encoded chunks are rewritten as a whole
+	  auto chunk = this->LoadChunk(slice->blob_id, layout.flags);
+	  if (!chunk) {
+		return static_cast<Status>(chunk);
+	  }
+	  const SizeType end = std::min<SizeType>(offset + data.Size(), slice->offset + chunk->Size());
+	  std::memcpy(chunk->Data() + (onset - slice->offset), data.Data() + (onset - offset), end - onset);
+	  status = this->RemoveChunks(file, slice->chunk_num, slice->chunk_num).Than([&]() {
+		return this->WriteChunk(file.Handle(),
+								slice->chunk_num,
+								slice->offset,
+								sqlite::Result<Chunk, Status>::Get(std::move(chunk)),
+								layout.flags);
+	  });
+	}
+  }
+  return status;
+}
+
+sqlite::Status FileSystem::Extend(const File &file, const Layout &layout, const sqlite::BlobBase &data) {
+  if (data.Size() <= 0) {
+	return Status();
+  }
+
+  // Small files get a chunk size worth growing into, content-defined ones keep their maximal size
+  const bool is_content_defined = (layout.flags & FLAG_CONTENT_DEFINED) != 0;
+  int chunk_size = layout.chunk_size;
+  if (is_content_defined) {
+	chunk_size = std::max(chunk_size, this->ChunkerParameters(chunk_size).maximal_size);
+  } else if (layout.chunks <= 1) {
+	chunk_size = std::max(chunk_size, GROWTH_CHUNK_SIZE);
+  }
+  chunk_size = static_cast<int>(std::min<SizeType>(chunk_size, database_.MaximalDataSize() - 64));
+
+  // A partially filled last chunk is merged with the new data, content-defined ones are chunked anew
+  const bool has_tail = layout.chunks > 0 && (is_content_defined || layout.last_chunk_size < chunk_size);
+  const SizeType tail_offset = has_tail ? layout.size - layout.last_chunk_size : layout.size;
+  const std::int_fast64_t tail_num = has_tail ? layout.chunks - 1 : layout.chunks;
+  Chunk combined(layout.size - tail_offset + data.Size());
+  Status status;
+  if (has_tail) {
+	std::vector<Slice> slices;
+	status = this->QuerySlices(file, tail_offset, layout.last_chunk_size, slices);
+	if (status && slices.size() != 1) {
+	  status = Status(SQLITE_CORRUPT);
+	}
+	if (status) {
+	  auto tail = this->LoadChunk(slices.front().blob_id, layout.flags);
+	  if (!tail || tail->Size() != layout.last_chunk_size) {
+		return tail ? Status(SQLITE_CORRUPT) : static_cast<Status>(tail);
+	  }
+	  std::memcpy(combined.Data(), tail->Data(), tail->Size());
+	  status = this->RemoveChunks(file, tail_num, tail_num);
+	}
+  }
+  if (!status) {
+	return status;
+  }
+  std::memcpy(combined.Data() + (layout.size - tail_offset), data.Data(), data.Size());
+
+  // Write the chunks and update the header accordingly
+  const SizeType size = layout.size + data.Size();
+  const std::int_fast64_t chunks = (size + chunk_size - 1) / chunk_size;
+  return this->WriteChunks(file.Handle(), tail_num, tail_offset, std::move(combined), chunk_size, layout.flags)
+	  .Than([&]() {
+		return this->Resize(file, chunk_size, size, chunks, static_cast<int>(size - (chunks - 1) * chunk_size));
+	  }).Than([&]() {
+		return is_content_defined ? layout_statement_.Execute(file.Handle()) : Status();
+	  });
+}
+
+sqlite::Status FileSystem::Stamp(sqlite::Database::RowId file_id,
+								 const std::optional<util::Sha256::Digest> &digest) {
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+	  std::chrono::system_clock::now().time_since_epoch()).count();
+  return stamp_statement_([&](Query &query) {
+	Status status = digest.has_value()
+					? query.Set(0, Blob<false>(digest->data(), static_cast<int>(digest->size())))
+					: query.Unset(0);
+	return status.Than([&]() {
+	  return query.Set(1, static_cast<std::int_fast64_t>(now));
+	}).Than([&]() {
+	  return query.Set(2, file_id);
+	}).Than([&]() {
+	  return query();
+	});
+  });
+}
+
+sqlite::Status FileSystem::Resize(const File &file,
+								  int chunk_size,
+								  SizeType size,
+								  std::int_fast64_t chunks,
+								  int last_chunk_size) {
+  return resize_statement_([&](Query &query) {
+	return query.Set(0, chunk_size)
+		.Than([&]() {
+		  return query.Set(1, size);
+		}).Than([&]() {
+		  return query.Set(2, chunks);
+		}).Than([&]() {
+		  return query.Set(3, last_chunk_size);
+		}).Than([&]() {
+		  return query.Set(4, file.Handle());
+		}).Than(query);
+  });
+}
+
+std::string_view FileSystem::BlobTable(int flags) const noexcept {
+  return (flags & FLAG_DEDUPLICATED) != 0 ? meta_.Content() : meta_.Data();
+}
+
+std::optional<Error> FileSystem::Read(const File &file, util::Reader &reader, SizeType start) const {
   // Load the chunks
   const auto chunk_status = chunk_statement_([&](Query &query) {
 	return query.SetByName(":handle", file.Handle())
 		.Than([&query, start] {
 		  return query.SetByName(":index", start);
 		}).Than([&query, &reader] {
-		  return query.SetByName(":size", reader->Length());
+		  return query.SetByName(":size", reader.Length());
 		}).Than([&query, &reader] {
-		  return reader->Add(query);
+		  return reader.Add(query);
 		});
   });
 
   if (!chunk_status) {
 	return Error(chunk_status);
-  } else if (reader->First() == -1) {
+  } else if (reader.First() == -1) {
 	return Error(errors::Io::OutOfBounds);
   }
 
   // Try to read the first blob
-  auto first_blob = BlobReader::Open(database_, reader->First(), meta_.Data(), "data");
+  auto first_blob = BlobReader::Open(database_, reader.First(), this->BlobTable(reader.Flags()), "data");
   if (first_blob) {
-	reader->SetFirstBlob(std::move(std::get<BlobReader>(first_blob)));
+	reader.SetFirstBlob(std::move(std::get<BlobReader>(first_blob)));
   } else {
 	return Error(std::get<Status>(first_blob));
   }
 
   // Read the blobs sequentially
   do {
-	auto tmp_result = (*reader)();
+	auto tmp_result = reader();
 	if (tmp_result.has_value()) {
 	  return tmp_result.value();
 	}
-  } while (!*reader);
+  } while (!reader);
   return std::nullopt;
 }
 
 std::optional<Error> FileSystem::Read(const File &file,
 									  std::string_view file_path,
-									  int start,
-									  int length,
+									  SizeType start,
+									  SizeType length,
 									  bool truncate,
-									  bool create_parents) const {
+									  bool create_parents,
+									  FileSystemPool *pool) const {
   // Create the required parent directories if they do not exists.
   const std::filesystem::path filesystem_path(file_path), parent = filesystem_path.parent_path();
-  if (!std::filesystem::is_directory(parent)) {
+  if (!parent.empty() && !std::filesystem::is_directory(parent)) {
 	if (create_parents) {
 	  std::error_code code;
 	  std::filesystem::create_directories(parent, code);
@@ -424,40 +1638,47 @@ std::optional<Error> FileSystem::Read(const File &file,
 	}
   }
 
-  std::ofstream output_file(file_path.data(),
-							std::ifstream::out | std::ifstream::binary
-								| (truncate ? std::ifstream::trunc : std::ifstream::app));
+  auto output_container = util::OutputFile::Open(file_path, truncate);
+  if (!output_container) {
+	return std::get<Error>(output_container);
+  }
+  auto &output_file = std::get<util::OutputFile>(output_container);
 
   // It is completely valid to have a file without content. But we need to handle this edge case.
   if (length <= 0) {
-	if (output_file) {
-	  return {};
-	} else {
-	  return Error(errors::Io::FileCreationFailed);
-	}
+	return std::nullopt;
   }
 
-  // This may inform the file system about the expected file size
-  output_file.seekp(length - 1);
-  output_file.write("1", 1);
-  output_file.seekp(0);
-  if (!output_file) {
+  // The space is allocated at once, so the file is neither fragmented nor running out of space halfway through
+  const SizeType file_offset = truncate ? 0 : output_file.Size();
+  if (file_offset < 0) {
 	return Error(errors::Io::WritingError);
+  } else if (auto error = output_file.Reserve(file_offset + length)) {
+	return error;
   }
 
-  if (output_file) {
-	auto result = this->Read(file, start, length, [&](Chunk data) {
-	  output_file.write(reinterpret_cast<const char *>(data.Data()), data.Size());
-	  return static_cast<bool>(output_file);
-	});
+  // Let several connections write their share of the chunks at their offset
+  if (pool != nullptr) {
+	return pool->Read(file, output_file, start, length, file_offset);
+  }
 
-	// Aborting does not count as error, we have to set it manually
-	if (!result.has_value() && !output_file) {
-	  return Error(errors::Io::WritingError);
-	}
-	return result;
-  } else {
-	return Error(errors::Io::FileCreationFailed);
+  // The chunks are read straight into the mapped file, if the space could be allocated
+  if (auto mapping = output_file.Map(file_offset, length)) {
+	return this->Read(file, start, mapping->Data(), length);
+  }
+
+  std::optional<Error> write_error;
+  SizeType offset = file_offset;
+  auto result = this->Read(file, start, length, [&](Chunk data) {
+	write_error = output_file.Write(offset, data.Data(), data.Size());
+	offset += data.Size();
+	return !write_error.has_value();
+  });
+
+  // Aborting does not count as error, we have to set it manually
+  if (!result.has_value() && write_error.has_value()) {
+	return write_error;
   }
+  return result;
 }
 }
\ No newline at end of file
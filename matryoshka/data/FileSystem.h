@@ -12,13 +12,21 @@ You should have received a copy of the GNU Affero General Public License along w
 #include "Error.h"
 #include "Folder.h"
 #include "File.h"
+#include "FileStream.h"
 #include "Path.h"
 #include "util/MetaTable.h"
 #include "util/Reader.h"
+#include "util/BufferReader.h"
+#include "util/ContentStore.h"
+#include "util/Chunker.h"
+#include "util/Codec.h"
+#include "util/Sha256.h"
 #include "sqlite/Database.h"
 #include "sqlite/PreparedStatement.h"
 #include "sqlite/Blob.h"
+#include "sqlite/BlobWriter.h"
 #include "sqlite/Result.h"
+#include "sqlite/Transaction.h"
 
 #include <variant>
 #include <optional>
@@ -26,13 +34,77 @@ You should have received a copy of the GNU Affero General Public License along w
 #include <functional>
 
 namespace matryoshka::data {
-template<typename T>
-using Result = sqlite::Result<T, Error>;
+class FileSystemPool;
 
 class FileSystem {
  public:
-  constexpr static util::MetaTable::Version CURRENT_VERSION = 0;
+  constexpr static util::MetaTable::Version CURRENT_VERSION = 5;
+  constexpr static int FLAG_DEDUPLICATED = 1 << 0;
+  constexpr static int FLAG_CONTENT_DEFINED = 1 << 1;
+  constexpr static int GROWTH_CHUNK_SIZE = 64 * 1024;
   using Chunk = sqlite::Blob<true>;
+  using SizeType = Chunk::SizeType;
+  using Buffer = util::BufferReader::Buffer;
+  using DeduplicationStatistics = util::ContentStore::Statistics;
+
+  /**
+   * The description of a file as stored in its header, available without touching its chunks.
+   */
+  struct Metadata {
+	SizeType size;
+	// The time of the last change in milliseconds since the epoch, if known.
+	std::optional<std::int_fast64_t> modified;
+	// The SHA-256 of the content as hex string, if known. Modifying a file in place discards it.
+	std::optional<std::string> hash;
+  };
+
+  /**
+   * The direct content of a folder.
+   */
+  struct Entry {
+	// The name relative to the listed folder.
+	std::string name;
+	// Folders have neither a size nor a hash, but the time of their creation.
+	bool is_folder;
+	Metadata metadata;
+  };
+
+  /**
+   * The settings applied to files created afterwards. Existing files keep the settings they were written with.
+   */
+  struct WriteOptions {
+	// Store chunks by their content hash, so identical chunks of any file are stored only once.
+	bool deduplicate = false;
+	// Cut chunks at boundaries defined by their content instead of at a fixed size, if set.
+	std::optional<util::Chunker::Parameters> content_defined_chunking;
+	// Compress each chunk with the given codec, if it shrinks.
+	util::Codec::Type codec = util::Codec::Type::Store;
+	// Stream uncompressed chunks larger than this size into preallocated blobs, bounding the memory used, if positive.
+	int buffer_size = 0;
+
+	// Options are set by name, so all others keep their defaults.
+	inline WriteOptions &SetDeduplicate(bool value) noexcept {
+	  deduplicate = value;
+	  return *this;
+	}
+
+	inline WriteOptions &SetContentDefinedChunking(std::optional<util::Chunker::Parameters> parameters) noexcept {
+	  content_defined_chunking = parameters;
+	  return *this;
+	}
+
+	inline WriteOptions &SetCodec(util::Codec::Type type) noexcept {
+	  codec = type;
+	  return *this;
+	}
+
+	inline WriteOptions &SetBufferSize(int size) noexcept {
+	  buffer_size = size;
+	  return *this;
+	}
+  };
+
+  class BatchWriter;
 
   static Result<FileSystem> Open(sqlite::Database &&database) noexcept;
   FileSystem(FileSystem &&other) noexcept;
@@ -40,24 +112,95 @@ class FileSystem {
   FileSystem &operator=(FileSystem const &) = delete;
 
   [[nodiscard]] Result<File> Open(const Path &path) noexcept;
-  [[nodiscard]] Result<Chunk> Read(const File &file, int start, int length) const;
+
+  /**
+   * Open an existing folder. Folders are created alongside the files within them or explicitly.
+   * @param path The path of the folder, which must not be the root.
+   * @return The folder handle.
+   */
+  [[nodiscard]] Result<Folder> OpenFolder(const Path &path) noexcept;
+  [[nodiscard]] Result<Chunk> Read(const File &file, SizeType start, SizeType length) const;
   [[nodiscard]] std::optional<Error> Read(const File &file,
-										  int start,
-										  int length,
+										  SizeType start,
+										  SizeType length,
 										  std::function<bool(Chunk &&)> callback) const;
+
+  /**
+   * Read a part of a file directly into memory provided by the caller, without any intermediate copy.
+   * @param file The opened and valid file handle.
+   * @param start The offset in the file.
+   * @param buffers The buffers which are filled one after the other.
+   * @param num_buffers The number of buffers.
+   * @return An error, if the range covered by the buffers could not be read completely.
+   */
+  [[nodiscard]] std::optional<Error> Read(const File &file,
+										  SizeType start,
+										  const Buffer *buffers,
+										  std::size_t num_buffers) const;
+  [[nodiscard]] inline std::optional<Error> Read(const File &file,
+												 SizeType start,
+												 void *destination,
+												 SizeType length) const {
+	const Buffer buffer{destination, length};
+	return this->Read(file, start, &buffer, 1);
+  }
+
+  /**
+   * Read a part of a file into a local file. Its space is allocated ahead and, if possible, mapped, so the chunks are
+   * read directly into it.
+   * @param file The opened and valid file handle.
+   * @param file_path The local file.
+   * @param start The offset in the file.
+   * @param length The number of bytes read.
+   * @param truncate Replace the content of the local file instead of appending to it.
+   * @param create_parents Create the missing parent directories of the local file.
+   * @param pool The connections the part is split between, if it should be read concurrently. They must be opened on
+   * the same container.
+   * @return An error, if the part could not be read or written completely.
+   */
   [[nodiscard]] std::optional<Error> Read(const File &file,
 										  std::string_view file_path,
-										  int start,
-										  int length,
+										  SizeType start,
+										  SizeType length,
 										  bool truncate = true,
-										  bool create_parents = true) const;
+										  bool create_parents = true,
+										  FileSystemPool *pool = nullptr) const;
 
   /**
-   * Query the size of a file.
+   * Query the size of a file. The size is stored in the header, so no chunk needs to be touched.
    * @param file The opened and valid file handle.
    * @return The size of the file in bytes.
    */
-  [[nodiscard]] int Size(const File &file);
+  [[nodiscard]] SizeType Size(const File &file);
+
+  /**
+   * Query the metadata of a file. It is stored in the header, so no chunk needs to be touched.
+   * @param file The opened and valid file handle.
+   * @return The metadata of the file.
+   */
+  [[nodiscard]] Result<Metadata> Stat(const File &file) const;
+
+  /**
+   * List the files and folders directly within a folder, ordered by their name. Each entry refers to its parent
+   * folder, so only the direct entries are read from the index on the parent.
+   * @param folder The folder, which is the root if the path is empty.
+   * @return The entries or an error, if the folder does not exist.
+   */
+  [[nodiscard]] Result<std::vector<Entry>> List(const Path &folder) const;
+
+  /**
+   * Open a stream for reading a file in many small pieces. The stream must not outlive the file system.
+   * @param file The opened and valid file handle.
+   * @return The stream positioned at the start of the file.
+   */
+  [[nodiscard]] Result<FileStream> Stream(const File &file) const;
+
+  /**
+   * Begin a transaction spanning several modifications, which are only kept once it is committed. Each modification
+   * within it is undone on its own if it fails.
+   * @return The transaction, which is rolled back unless committed.
+   */
+  Result<sqlite::Transaction> Begin();
 
   /**
    * Delete a file in the database. The file handle is moved and must not be used.
@@ -66,10 +209,100 @@ class FileSystem {
    */
   bool Delete(File &&file);
 
+  /**
+   * Delete a folder with all files and folders within it. The folder handle is moved and must not be used.
+   * @param folder The opened and valid folder.
+   * @return True, if deleting the folder was successful.
+   */
+  bool Delete(Folder &&folder);
+
+  /**
+   * Create a folder and all its missing parents.
+   * @param path The path of the folder, which must not be the root.
+   * @return The new or already existing folder. It fails, if a file occupies the path of the folder or a parent.
+   */
+  Result<Folder> CreateFolder(const Path &path);
+
+  /**
+   * Move a file or a folder with all its content. Only the paths are changed, no chunk is touched. Moving a folder
+   * rewrites the path of every entry within it, so it takes time proportional to the size of its subtree while the
+   * container is locked for writing.
+   * @param from The existing file or folder.
+   * @param to The new path, which must not exist yet. Missing parents are created.
+   * @return An error, if the entry could not be moved. On failure, nothing is changed.
+   */
+  std::optional<Error> Move(const Path &from, const Path &to);
+
+  /**
+   * Copy a file or a folder with all its content. The chunks are copied within the database, while chunks stored
+   * deduplicated are shared by reference.
+   * @param from The existing file or folder.
+   * @param to The path of the copy, which must not exist yet. Missing parents are created.
+   * @return An error, if the entry could not be copied. On failure, nothing is changed.
+   */
+  std::optional<Error> Copy(const Path &from, const Path &to);
+
   Result<File> Create(const Path &path, Chunk &&data, int chunk_size = -1);
+
+  /**
+   * Create a file from content hashed already, i.e. on another thread.
+   * @param path The path of the new file.
+   * @param data The content of the file.
+   * @param digest The SHA-256 of the content, which is stored as is.
+   * @param chunk_size The proposed chunk size. Negative values let the file system choose.
+   * @return The new file.
+   */
+  Result<File> Create(const Path &path, Chunk &&data, const util::Sha256::Digest &digest, int chunk_size = -1);
   Result<File> Create(const Path &path, std::string_view file_path, int chunk_size = -1);
-  Result<File> Create(const Path &path, std::function<Chunk(int)> data, int file_size, int chunk_size = -1);
+  Result<File> Create(const Path &path, std::function<Chunk(int)> data, SizeType file_size, int chunk_size = -1);
   void Find(const Path &path, std::vector<Path> &files) const noexcept;
+
+  /**
+   * Start creating many files within few transactions. The writer must not outlive the file system.
+   * @param batch_size The number of files committed together.
+   * @param isolate_failures Discard only a failing file instead of all files not committed yet.
+   * @return The writer, which has not opened a transaction yet.
+   */
+  [[nodiscard]] BatchWriter Batch(int batch_size = 1000, bool isolate_failures = true) noexcept;
+
+  /**
+   * Overwrite a part of an existing file in place. Only the chunks covering the range are touched.
+   * @param file The opened and valid file handle.
+   * @param offset The offset in the file, which must not exceed its size.
+   * @param data The new content. Bytes beyond the end of the file are appended.
+   * @return An error, if the file could not be modified. On failure, the file is left untouched.
+   */
+  std::optional<Error> Write(const File &file, SizeType offset, const sqlite::BlobBase &data);
+
+  /**
+   * Append data to the end of an existing file. Only a partially filled last chunk is rewritten.
+   * @param file The opened and valid file handle.
+   * @param data The content to append.
+   * @return An error, if the file could not be modified. On failure, the file is left untouched.
+   */
+  std::optional<Error> Append(const File &file, const sqlite::BlobBase &data);
+
+  /**
+   * Shrink an existing file. Chunks beyond the new end are removed and the last one is cut.
+   * @param file The opened and valid file handle.
+   * @param size The new size, which must not exceed the current one.
+   * @return An error, if the file could not be modified. On failure, the file is left untouched.
+   */
+  std::optional<Error> Truncate(const File &file, SizeType size);
+
+  [[nodiscard]] inline const WriteOptions &GetWriteOptions() const noexcept {
+	return options_;
+  }
+
+  inline void SetWriteOptions(const WriteOptions &options) noexcept {
+	options_ = options;
+  }
+
+  /**
+   * Summarize the chunks shared between deduplicated files.
+   * @return The number of references and unique chunks alongside the bytes referenced and actually stored.
+   */
+  [[nodiscard]] Result<DeduplicationStatistics> Deduplication() const;
   inline void Find(std::vector<Path> &files) const noexcept {
 	this->Find(Path("*"), files);
   }
@@ -83,22 +316,205 @@ class FileSystem {
 			 sqlite::PreparedStatement &&glob_statement_,
 			 sqlite::PreparedStatement &&size_statement_,
 			 sqlite::PreparedStatement &&delete_statement_,
+			 sqlite::PreparedStatement &&stream_statement_,
+			 sqlite::PreparedStatement &&reference_statement_,
+			 sqlite::PreparedStatement &&layout_statement_,
+			 sqlite::PreparedStatement &&dimension_statement_,
+			 sqlite::PreparedStatement &&resize_statement_,
+			 sqlite::PreparedStatement &&remove_statement_,
+			 sqlite::PreparedStatement &&stamp_statement_,
+			 sqlite::PreparedStatement &&stat_statement_,
+			 sqlite::PreparedStatement &&list_statement_,
+			 sqlite::PreparedStatement &&move_statement_,
+			 sqlite::PreparedStatement &&rename_statement_,
+			 sqlite::PreparedStatement &&copy_header_statement_,
+			 sqlite::PreparedStatement &&copy_chunks_statement_,
+			 sqlite::PreparedStatement &&share_statement_,
+			 util::ContentStore &&content,
 			 util::MetaTable meta_table) noexcept;
 
   sqlite::Result<sqlite::Database::RowId, sqlite::Status> CreateHeader(const Path &path,
 																	   int chunk_size,
-																	   FileSystemObjectType type) noexcept;
+																	   FileSystemObjectType type,
+																	   SizeType file_size,
+																	   int flags = 0) noexcept;
+
+  /**
+   * Query the handle of a folder and create it, if it does not exist yet. Its parents are created alongside.
+   * @param path The path of the folder.
+   * @return The handle of the folder, which is empty for the root.
+   */
+  sqlite::Result<std::optional<sqlite::Database::RowId>, sqlite::Status> RequireFolder(const Path &path) noexcept;
+
+  /**
+   * Check the arguments of Move and Copy and query the entry at the source.
+   * @param from The source, which must exist.
+   * @param to The destination, which must neither exist nor be within the source.
+   * @return The handle of the source and whether it is a folder.
+   */
+  Result<std::pair<sqlite::Database::RowId, bool>> QueryTransfer(const Path &from, const Path &to) noexcept;
+
+  /**
+   * Copy a header alongside its chunks or, for folders, its content recursively.
+   * @param id The handle of the source.
+   * @param is_folder Whether the source is a folder.
+   * @param destination The path of the copy.
+   * @param parent The folder of the copy.
+   * @return The status of the copy.
+   */
+  sqlite::Status Duplicate(sqlite::Database::RowId id,
+						   bool is_folder,
+						   const std::string &destination,
+						   std::optional<sqlite::Database::RowId> parent);
  private:
+  /**
+   * Upgrade the schema of an older container to the current version in place.
+   * @param database The database containing the container.
+   * @param meta The meta table of the container found.
+   * @return The status of the migration. On failure, the container is left untouched.
+   */
+  static sqlite::Status Migrate(sqlite::Database &database, const util::MetaTable &meta) noexcept;
+
+  // The layout of a file as stored in its header.
+  struct Layout {
+	int flags, chunk_size;
+	SizeType size;
+	std::int_fast64_t chunks;
+	int last_chunk_size;
+  };
+
+  // A chunk covering a range of a file.
+  struct Slice {
+	sqlite::Database::RowId blob_id;
+	std::int_fast64_t chunk_num;
+	SizeType offset;
+  };
+
   Result<File> Create(const Path &path,
-					  std::function<sqlite::Status(sqlite::Database::RowId, int)> file_creation,
-					  int file_size,
-					  int chunk_size = -1);
-  std::optional<Error> Read(const File &file, util::Reader *reader, int start) const;
+					  std::function<sqlite::Status(sqlite::Database::RowId, int, int)> file_creation,
+					  const std::function<util::Sha256::Digest()> &digest,
+					  SizeType file_size,
+					  int chunk_size);
+
+  /**
+   * Record the modification of a file in its header.
+   * @param file_id The header of the file.
+   * @param digest The hash of the new content. Without it, the hash is discarded.
+   * @return The status of the update.
+   */
+  sqlite::Status Stamp(sqlite::Database::RowId file_id, const std::optional<util::Sha256::Digest> &digest);
+
+  /**
+   * Read the metadata from the columns "size", "modified" and "hash" of a query.
+   * @param query The query with a row available.
+   * @param column The index of the "size" column, which the other ones follow.
+   * @return The metadata of the row.
+   */
+  static Metadata ReadMetadata(const sqlite::Query &query, int column);
+  std::optional<Error> Read(const File &file, util::Reader &reader, SizeType start) const;
+  Result<Layout> QueryLayout(const File &file) const;
+  sqlite::Status QuerySlices(const File &file, SizeType start, SizeType length, std::vector<Slice> &slices) const;
+  sqlite::Result<Chunk, sqlite::Status> LoadChunk(sqlite::Database::RowId blob_id, int flags) const;
+  sqlite::Status RemoveChunks(const File &file, std::int_fast64_t first_chunk_num, std::int_fast64_t last_chunk_num);
+  sqlite::Status Overwrite(const File &file, const Layout &layout, SizeType offset, const sqlite::BlobBase &data);
+  sqlite::Status Extend(const File &file, const Layout &layout, const sqlite::BlobBase &data);
+  sqlite::Status Resize(const File &file, int chunk_size, SizeType size, std::int_fast64_t chunks, int last_chunk_size);
+  template<bool HasOwnership>
+  sqlite::Status WriteChunks(sqlite::Database::RowId file_id,
+							 std::int_fast64_t chunk_num,
+							 SizeType offset,
+							 sqlite::Blob<HasOwnership> &&data,
+							 int chunk_size,
+							 int flags);
+  [[nodiscard]] util::Chunker::Parameters ChunkerParameters(int maximal_size) const noexcept;
+  sqlite::Status WriteContentDefined(sqlite::Database::RowId file_id,
+									 std::function<Chunk(int)> &data_source,
+									 SizeType file_size,
+									 int flags);
+  sqlite::Status WriteStreamed(sqlite::Database::RowId file_id,
+							   std::function<Chunk(int)> &data_source,
+							   SizeType file_size,
+							   int chunk_size);
+
+  /**
+   * Write chunks too large for the buffer by allocating them in the database and filling them incrementally.
+   * @param file_id The header of the file.
+   * @param fill Writes a piece of at most buffer_size bytes into the chunk, given its offset in the chunk and in the file.
+   * @param file_size The size of the file.
+   * @param chunk_size The size of the chunks.
+   * @return The status of the insertion.
+   */
+  sqlite::Status WriteStreamed(sqlite::Database::RowId file_id,
+							   const std::function<sqlite::Status(sqlite::BlobWriter &, int, SizeType, int)> &fill,
+							   SizeType file_size,
+							   int chunk_size);
+
+  /**
+   * Write a single chunk of a file, either directly or as a reference into the content store.
+   * @param file_id The header of the file.
+   * @param chunk_num The index of the chunk in the file.
+   * @param offset The offset of the chunk in the file, which is only stored for content-defined chunks.
+   * @param data The content of the chunk.
+   * @param flags The flags of the file.
+   * @return The status of the insertion.
+   */
+  template<bool HasOwnership>
+  sqlite::Status WriteChunk(sqlite::Database::RowId file_id,
+							std::int_fast64_t chunk_num,
+							SizeType offset,
+							sqlite::Blob<HasOwnership> &&data,
+							int flags);
+  [[nodiscard]] std::string_view BlobTable(int flags) const noexcept;
 
   sqlite::Database database_;
   sqlite::PreparedStatement handle_statement_, chunk_statement_, header_statement_, blob_statement_, glob_statement_,
-	  size_statement_, delete_statement_;
+	  size_statement_, delete_statement_, stream_statement_, reference_statement_,
+	  layout_statement_, dimension_statement_, resize_statement_, remove_statement_, stamp_statement_, stat_statement_,
+	  list_statement_, move_statement_, rename_statement_, copy_header_statement_, copy_chunks_statement_,
+	  share_statement_;
+  util::ContentStore content_;
   util::MetaTable meta_;
+  WriteOptions options_;
+};
+
+/**
+ * Creates many files within shared transactions, as committing each file on its own waits for the disk. Each file is
+ * written within a savepoint of the batch, so a failing file is undone on its own. Files become visible to other
+ * connections only once their batch is committed.
+ */
+class FileSystem::BatchWriter {
+ public:
+  BatchWriter(FileSystem *file_system, int batch_size, bool isolate_failures) noexcept;
+  BatchWriter(BatchWriter &&other) noexcept = default;
+  BatchWriter(BatchWriter const &) = delete;
+  BatchWriter &operator=(BatchWriter const &) = delete;
+
+  Result<File> Create(const Path &path, Chunk &&data, int chunk_size = -1);
+  Result<File> Create(const Path &path, Chunk &&data, const util::Sha256::Digest &digest, int chunk_size = -1);
+  Result<File> Create(const Path &path, std::string_view file_path, int chunk_size = -1);
+  Result<File> Create(const Path &path, std::function<Chunk(int)> data, SizeType file_size, int chunk_size = -1);
+
+  /**
+   * Commit all files created since the last commit. Files not committed are discarded with the writer.
+   * @return An error, if the files could not be committed. On failure, they are discarded.
+   */
+  std::optional<Error> Commit();
+
+  /**
+   * Query the number of files created, but not committed yet.
+   * @return The number of pending files.
+   */
+  [[nodiscard]] inline int Pending() const noexcept {
+	return pending_;
+  }
+
+ private:
+  Result<File> Add(const std::function<Result<File>()> &creation);
+
+  FileSystem *file_system_;
+  std::optional<sqlite::Transaction> transaction_;
+  int batch_size_, pending_;
+  bool isolate_failures_;
 };
 }
 
@@ -0,0 +1,257 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "FileSystemPool.h"
+
+#include <numeric>
+#include <algorithm>
+#include <utility>
+#include <thread>
+#include <atomic>
+#include <filesystem>
+#include <set>
+
+namespace matryoshka::data {
+
+FileSystemPool::Lease::Lease(FileSystemPool *pool, std::size_t index) noexcept
+	: pool_(pool), index_(index), file_system_(&pool->file_systems_[index]) {}
+
+FileSystemPool::Lease::Lease(Lease &&other) noexcept
+	: pool_(other.pool_), index_(other.index_), file_system_(other.file_system_) {
+  other.pool_ = nullptr;
+}
+
+FileSystemPool::Lease::~Lease() noexcept {
+  if (pool_ != nullptr) {
+	pool_->Release(index_);
+  }
+}
+
+FileSystemPool::FileSystemPool(std::vector<FileSystem> &&file_systems) noexcept
+	: file_systems_(std::move(file_systems)), available_(file_systems_.size()) {
+  std::iota(available_.begin(), available_.end(), 0);
+}
+
+Result<std::unique_ptr<FileSystemPool>> FileSystemPool::Open(std::string_view path,
+															 std::size_t size,
+															 sqlite::Database::Options options) {
+  if (size == 0) {
+	return Result<std::unique_ptr<FileSystemPool>>::Fail(errors::ArgumentError());
+  }
+
+  // The settings stored in the file are up to the writer. Each connection prepares its own statements.
+  options.read_only = true;
+  options.journal = sqlite::Database::Options::Journal::Keep;
+  options.page_size = -1;
+  std::vector<FileSystem> file_systems;
+  file_systems.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+	auto database = sqlite::Database::Create(path, options);
+	if (!database) {
+	  return Result<std::unique_ptr<FileSystemPool>>::Fail(static_cast<sqlite::Status>(database));
+	}
+	auto file_system = FileSystem::Open(std::move(std::get<sqlite::Database>(database)));
+	if (!file_system) {
+	  return Result<std::unique_ptr<FileSystemPool>>::Fail(std::get<Error>(file_system));
+	}
+	file_systems.emplace_back(std::move(std::get<FileSystem>(file_system)));
+  }
+
+  // The pool itself is not movable, as leases refer to it
+  return Result<std::unique_ptr<FileSystemPool>>(
+	  std::unique_ptr<FileSystemPool>(new FileSystemPool(std::move(file_systems))));
+}
+
+FileSystemPool::Lease FileSystemPool::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  released_.wait(lock, [this] { return !available_.empty(); });
+  const std::size_t index = available_.back();
+  available_.pop_back();
+  return Lease(this, index);
+}
+
+std::optional<FileSystemPool::Lease> FileSystemPool::TryAcquire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (available_.empty()) {
+	return std::nullopt;
+  }
+  const std::size_t index = available_.back();
+  available_.pop_back();
+  return Lease(this, index);
+}
+
+std::vector<FileSystemPool::Lease> FileSystemPool::AcquireAvailable(std::size_t maximal) {
+  std::vector<Lease> leases;
+  leases.reserve(maximal);
+  leases.emplace_back(this->Acquire());
+
+  // Waiting for more would deadlock a caller holding a lease on its own
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (leases.size() < maximal && !available_.empty()) {
+	leases.emplace_back(Lease(this, available_.back()));
+	available_.pop_back();
+  }
+  return leases;
+}
+
+template<typename W>
+std::optional<Error> FileSystemPool::Distribute(SizeType length, W worker) {
+  if (length <= 0) {
+	return std::nullopt;
+  }
+  auto leases = this->AcquireAvailable(static_cast<std::size_t>(std::clamp<SizeType>(length / MINIMAL_SHARE,
+																					  1,
+																					  static_cast<SizeType>(this->Size()))));
+  const std::size_t num_shares = leases.size();
+  const SizeType share = (length + num_shares - 1) / num_shares;
+
+  // The first error reported by any worker wins
+  std::optional<Error> result;
+  std::mutex result_mutex;
+  auto run = [&](std::size_t index) {
+	const SizeType offset = static_cast<SizeType>(index) * share;
+	auto error = worker(*leases[index], offset, std::min(share, length - offset));
+	if (error.has_value()) {
+	  std::lock_guard<std::mutex> lock(result_mutex);
+	  if (!result.has_value()) {
+		result = error;
+	  }
+	}
+  };
+
+  // The calling thread takes the first share itself
+  std::vector<std::thread> threads;
+  threads.reserve(num_shares - 1);
+  for (std::size_t i = 1; i < num_shares; ++i) {
+	threads.emplace_back(run, i);
+  }
+  run(0);
+  for (auto &thread: threads) {
+	thread.join();
+  }
+  return result;
+}
+
+std::optional<Error> FileSystemPool::Read(const File &file, SizeType start, void *destination, SizeType length) {
+  auto *output = static_cast<unsigned char *>(destination);
+  return this->Distribute(length, [&](FileSystem &file_system, SizeType offset, SizeType share) {
+	return file_system.Read(file, start + offset, output + offset, share);
+  });
+}
+
+std::optional<Error> FileSystemPool::Read(const File &file,
+										  std::string_view file_path,
+										  SizeType start,
+										  SizeType length,
+										  SizeType file_offset) {
+  auto output = util::OutputFile::Open(file_path, false);
+  if (!output) {
+	return std::get<Error>(output);
+  }
+  return this->Read(file, std::get<util::OutputFile>(output), start, length, file_offset);
+}
+
+std::optional<Error> FileSystemPool::Read(const File &file,
+										  util::OutputFile &output,
+										  SizeType start,
+										  SizeType length,
+										  SizeType file_offset) {
+  // The workers fill their share of a mapped file without buffering the chunks first
+  if (auto mapping = output.Map(file_offset, length)) {
+	return this->Read(file, start, mapping->Data(), length);
+  }
+
+  return this->Distribute(length, [&](FileSystem &file_system, SizeType offset, SizeType share) {
+	// Positional writes do not share a position, so the workers do not interfere
+	std::optional<Error> write_error;
+	SizeType position = file_offset + offset;
+	auto error = file_system.Read(file, start + offset, share, [&](FileSystem::Chunk &&data) {
+	  write_error = output.Write(position, data.Data(), data.Size());
+	  position += data.Size();
+	  return !write_error.has_value();
+	});
+	if (!error.has_value() && write_error.has_value()) {
+	  return write_error;
+	}
+	return error;
+  });
+}
+
+FileSystemPool::ExportSummary FileSystemPool::Export(const Path &pattern,
+													 std::string_view directory,
+													 const ExportFailureCallback &on_failure) {
+  std::vector<Path> paths;
+  {
+	auto lease = this->Acquire();
+	lease->Find(pattern, paths);
+  }
+
+  // The directories are created up front, as the workers would race on creating shared parents
+  const std::filesystem::path base(directory);
+  std::set<std::filesystem::path> parents;
+  for (const auto &path: paths) {
+	parents.insert((base / path.AbsolutePath()).parent_path());
+  }
+  for (const auto &parent: parents) {
+	std::error_code code;
+	std::filesystem::create_directories(parent, code);
+  }
+
+  // Each worker takes the next file not taken yet, so large and small files even out
+  ExportSummary summary{0, 0, 0};
+  std::mutex summary_mutex;
+  std::atomic<std::size_t> next_path(0);
+  auto run = [&](const Lease &lease) {
+	for (std::size_t index = next_path++; index < paths.size(); index = next_path++) {
+	  SizeType size = 0;
+	  std::optional<Error> error;
+	  auto file = lease->Open(paths[index]);
+	  if (file) {
+		size = lease->Size(std::get<File>(file));
+		error = lease->Read(std::get<File>(file), (base / paths[index].AbsolutePath()).string(), 0, size);
+	  } else {
+		error = std::get<Error>(file);
+	  }
+
+	  std::lock_guard<std::mutex> lock(summary_mutex);
+	  if (!error.has_value()) {
+		++summary.num_exported;
+		summary.bytes_exported += size;
+	  } else {
+		++summary.num_failed;
+		if (on_failure) {
+		  on_failure(paths[index], error.value());
+		}
+	  }
+	}
+  };
+
+  // The calling thread works alongside the others
+  auto leases = this->AcquireAvailable(std::clamp<std::size_t>(paths.size(), 1, this->Size()));
+  std::vector<std::thread> threads;
+  threads.reserve(leases.size() - 1);
+  for (std::size_t i = 1; i < leases.size(); ++i) {
+	threads.emplace_back(run, std::cref(leases[i]));
+  }
+  run(leases.front());
+  for (auto &thread: threads) {
+	thread.join();
+  }
+  return summary;
+}
+
+void FileSystemPool::Release(std::size_t index) noexcept {
+  {
+	std::lock_guard<std::mutex> lock(mutex_);
+	available_.push_back(index);
+  }
+  released_.notify_one();
+}
+
+}
\ No newline at end of file
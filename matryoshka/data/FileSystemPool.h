@@ -0,0 +1,186 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MATRYOSHKA_MATRYOSHKA_DATA_FILESYSTEMPOOL_H_
+#define MATRYOSHKA_MATRYOSHKA_DATA_FILESYSTEMPOOL_H_
+
+#include "FileSystem.h"
+#include "Error.h"
+#include "sqlite/Database.h"
+#include "util/OutputFile.h"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <string_view>
+#include <functional>
+
+namespace matryoshka::data {
+/**
+ * A fixed number of read-only connections to the same container, each with its own prepared statements. A file system
+ * is not safe for concurrent use, so every thread leases one exclusively. Files opened on one connection are valid on
+ * all others.
+ */
+class FileSystemPool {
+ public:
+  using SizeType = FileSystem::SizeType;
+
+  // Shares smaller than this are not worth a thread of their own.
+  constexpr static SizeType MINIMAL_SHARE = 64 * 1024;
+
+  // The outcome of an export.
+  struct ExportSummary {
+	int num_exported, num_failed;
+	SizeType bytes_exported;
+  };
+
+  using ExportFailureCallback = std::function<void(const Path &, const Error &)>;
+
+  /**
+   * The exclusive access to a file system of the pool, which is returned once the lease is destroyed.
+   */
+  class Lease {
+   public:
+	Lease(Lease &&other) noexcept;
+	~Lease() noexcept;
+	Lease(Lease const &) = delete;
+	Lease &operator=(Lease const &) = delete;
+
+	inline FileSystem &operator*() const noexcept {
+	  return *file_system_;
+	}
+
+	inline FileSystem *operator->() const noexcept {
+	  return file_system_;
+	}
+
+   protected:
+	friend class FileSystemPool;
+	Lease(FileSystemPool *pool, std::size_t index) noexcept;
+
+   private:
+	FileSystemPool *pool_;
+	std::size_t index_;
+	FileSystem *file_system_;
+  };
+
+  /**
+   * Open the connections of the pool. If the container is in WAL mode, the readers may proceed alongside a writer.
+   * @param path The path to an existing container.
+   * @param size The number of connections, which is the maximal number of concurrent readers.
+   * @param options The tuning applied to each connection. They are always opened read-only, so the journal mode and
+   * the page size are kept.
+   * @return The pool or the error on opening any connection.
+   */
+  static Result<std::unique_ptr<FileSystemPool>> Open(std::string_view path,
+													  std::size_t size,
+													  sqlite::Database::Options options = sqlite::Database::Options());
+  FileSystemPool(FileSystemPool const &) = delete;
+  FileSystemPool &operator=(FileSystemPool const &) = delete;
+
+  /**
+   * Lease a file system, waiting until one is available.
+   * @return The lease, which must not outlive the pool.
+   */
+  Lease Acquire();
+
+  /**
+   * Lease a file system, if one is available right now.
+   * @return The lease, which must not outlive the pool.
+   */
+  std::optional<Lease> TryAcquire();
+
+  [[nodiscard]] inline std::size_t Size() const noexcept {
+	return file_systems_.size();
+  }
+
+  /**
+   * Read a part of a file in parallel. Each connection copies its share of the chunks directly into the memory. Only
+   * the connections available at the call are used, so the caller may hold a lease itself, but not all of them.
+   * @param file The opened and valid file handle.
+   * @param start The offset in the file.
+   * @param destination The memory written to. It needs to hold at least length bytes.
+   * @param length The number of bytes read.
+   * @return An error, if any share could not be read completely.
+   */
+  std::optional<Error> Read(const File &file, SizeType start, void *destination, SizeType length);
+
+  /**
+   * Read a part of a file into a local file in parallel. Each connection writes its share at the according offset.
+   * Like all reads of the pool, it must not be called while holding all of its leases.
+   * @param file The opened and valid file handle.
+   * @param file_path The local file, which must exist already. It is neither truncated nor created.
+   * @param start The offset in the file.
+   * @param length The number of bytes read.
+   * @param file_offset The offset in the local file the part is written to.
+   * @return An error, if any share could not be read or written completely.
+   */
+  std::optional<Error> Read(const File &file,
+							std::string_view file_path,
+							SizeType start,
+							SizeType length,
+							SizeType file_offset = 0);
+
+  /**
+   * Read a part of a file into an opened local file in parallel. Each connection writes its share at the according
+   * offset, without any lock between them. If the part was reserved in the local file, it is mapped and the shares are
+   * read straight into it. Like all reads of the pool, it must not be called while holding all of its leases.
+   * @param file The opened and valid file handle.
+   * @param output The local file, which is neither truncated nor extended beforehand.
+   * @param start The offset in the file.
+   * @param length The number of bytes read.
+   * @param file_offset The offset in the local file the part is written to.
+   * @return An error, if any share could not be read or written completely.
+   */
+  std::optional<Error> Read(const File &file,
+							util::OutputFile &output,
+							SizeType start,
+							SizeType length,
+							SizeType file_offset = 0);
+
+  /**
+   * Extract all files matching a pattern into a local directory, keeping their relative paths. The files are
+   * distributed over the connections available at the call, each writing whole files into space allocated ahead. It
+   * must not be called while holding all leases of the pool.
+   * @param pattern The pattern of the files, as used by FileSystem::Find.
+   * @param directory The local directory, which is created if required. Existing files are replaced.
+   * @param on_failure Called for each file which could not be extracted, if set. It is called from the workers, but
+   * never concurrently.
+   * @return The number of files and bytes extracted alongside the number of files skipped.
+   */
+  ExportSummary Export(const Path &pattern,
+					   std::string_view directory,
+					   const ExportFailureCallback &on_failure = nullptr);
+
+ protected:
+  explicit FileSystemPool(std::vector<FileSystem> &&file_systems) noexcept;
+
+ private:
+  void Release(std::size_t index) noexcept;
+
+  /**
+   * Lease a file system, waiting until one is available, and as many others as are available right now.
+   * @param maximal The maximal number of leases.
+   * @return At least one and at most the given number of leases.
+   */
+  std::vector<Lease> AcquireAvailable(std::size_t maximal);
+
+  template<typename W>
+  std::optional<Error> Distribute(SizeType length, W worker);
+
+  std::vector<FileSystem> file_systems_;
+  std::vector<std::size_t> available_;
+  std::mutex mutex_;
+  std::condition_variable released_;
+};
+}
+
+#endif //MATRYOSHKA_MATRYOSHKA_DATA_FILESYSTEMPOOL_H_
@@ -13,7 +13,18 @@ You should have received a copy of the GNU Affero General Public License along w
 
 namespace matryoshka::data {
 class Folder : public FileSystemObject<0> {
+ public:
   constexpr explicit Folder(FileSystemObject::HandleType handle) noexcept: FileSystemObject(handle) {}
+
+  inline Folder(Folder &&other) noexcept: Folder(other.Handle()) {
+	other.Invalidate();
+  }
+
+  Folder &operator=(Folder &&other) noexcept {
+	id_ = other.id_;
+	other.Invalidate();
+	return *this;
+  }
 };
 }
 
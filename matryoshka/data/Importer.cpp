@@ -0,0 +1,156 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Importer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <map>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace matryoshka::data {
+
+Importer::Importer(FileSystem *file_system, const Options &options) noexcept
+	: file_system_(file_system), options_(options) {
+  assert(file_system_ != nullptr);
+  options_.num_readers = std::max<std::size_t>(options_.num_readers, 1);
+  options_.batch_size = std::max(options_.batch_size, 1);
+}
+
+Importer::Loaded Importer::Load(const Job &job, std::size_t index, SizeType size) {
+  Loaded loaded{index, size, std::nullopt, {}, std::nullopt};
+  std::ifstream file(job.file_path, std::ifstream::in | std::ifstream::binary);
+  if (!file) {
+	loaded.error = Error(errors::Io::FileNotFound);
+	return loaded;
+  }
+
+  FileSystem::Chunk data(size);
+  if (!file.read(reinterpret_cast<char *>(data.Data()), size)) {
+	loaded.error = Error(errors::Io::ReadingError);
+	return loaded;
+  }
+  loaded.digest = util::Sha256::Hash(data);
+  loaded.data = std::move(data);
+  return loaded;
+}
+
+Result<Importer::Summary> Importer::Import(const std::vector<Job> &jobs, const FailureCallback &on_failure) {
+  std::mutex mutex;
+  std::condition_variable loaded_condition, space_condition;
+  std::map<std::size_t, Loaded> loaded_jobs;
+  std::size_t next_job = 0, next_written = 0;
+  SizeType buffered = 0;
+  bool is_stopped = false;
+
+  auto read = [&]() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!is_stopped && next_job < jobs.size()) {
+	  const std::size_t index = next_job++;
+	  lock.unlock();
+
+	  // Files exceeding the buffer are left to the writer, which streams them chunk by chunk
+	  std::error_code error_code;
+	  const auto size = static_cast<SizeType>(std::filesystem::file_size(jobs[index].file_path, error_code));
+	  Loaded loaded{index, 0, std::nullopt, {}, std::nullopt};
+	  if (error_code) {
+		loaded.error = Error(errors::Io::FileNotFound);
+	  } else if (size <= options_.buffer_size) {
+		// A file is loaded only once the buffer has room for it, so memory stays bound however slow the writer is. The
+		// file awaited by the writer is always admitted, as the buffer may be occupied by the files following it.
+		lock.lock();
+		space_condition.wait(lock, [&]() {
+		  return is_stopped || index == next_written || buffered + size <= options_.buffer_size;
+		});
+		buffered += size;
+		lock.unlock();
+		loaded = Importer::Load(jobs[index], index, size);
+	  }
+
+	  lock.lock();
+	  loaded_jobs.emplace(index, std::move(loaded));
+	  loaded_condition.notify_one();
+	}
+  };
+
+  std::vector<std::thread> readers;
+  const std::size_t num_readers = std::min(options_.num_readers, jobs.size());
+  readers.reserve(num_readers);
+  for (std::size_t i = 0; i < num_readers; ++i) {
+	readers.emplace_back(read);
+  }
+  auto stop = [&]() {
+	{
+	  std::lock_guard<std::mutex> lock(mutex);
+	  is_stopped = true;
+	}
+	space_condition.notify_all();
+	for (auto &reader: readers) {
+	  reader.join();
+	}
+  };
+
+  // The batch is committed manually, so a failing commit is told apart from a failing file
+  auto batch = file_system_->Batch(std::numeric_limits<int>::max());
+  Summary summary{0, 0};
+  for (std::size_t index = 0; index < jobs.size(); ++index) {
+	// The files are written in the order of the jobs, so the outcome does not depend on the speed of the readers
+	std::unique_lock<std::mutex> lock(mutex);
+	loaded_condition.wait(lock, [&]() {
+	  return loaded_jobs.count(index) > 0;
+	});
+	auto node = loaded_jobs.extract(index);
+	Loaded &loaded = node.mapped();
+	lock.unlock();
+
+	const Job &job = jobs[loaded.job];
+	Result<File> result = loaded.error.has_value() ? Result<File>(loaded.error.value())
+												   : loaded.data.has_value()
+													 ? batch.Create(job.path,
+																	std::move(loaded.data.value()),
+																	loaded.digest,
+																	options_.chunk_size)
+													 : batch.Create(job.path, job.file_path, options_.chunk_size);
+	loaded.data.reset();
+	lock.lock();
+	buffered -= loaded.size;
+	next_written = index + 1;
+	lock.unlock();
+	space_condition.notify_all();
+
+	if (!result) {
+	  ++summary.num_failed;
+	  if (on_failure) {
+		on_failure(job, std::get<Error>(result));
+	  }
+	} else if (batch.Pending() >= options_.batch_size) {
+	  const int num_pending = batch.Pending();
+	  if (auto error = batch.Commit()) {
+		stop();
+		return Result<Summary>::Fail(std::move(error.value()));
+	  }
+	  summary.num_imported += num_pending;
+	}
+  }
+  stop();
+
+  const int num_pending = batch.Pending();
+  if (auto error = batch.Commit()) {
+	return Result<Summary>::Fail(std::move(error.value()));
+  }
+  summary.num_imported += num_pending;
+  return Result<Summary>::Ok(summary);
+}
+
+}
\ No newline at end of file
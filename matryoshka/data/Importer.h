@@ -0,0 +1,85 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_MATRYOSHKA_DATA_IMPORTER_H_
+#define MATRYOSHKA_MATRYOSHKA_DATA_IMPORTER_H_
+
+#include "FileSystem.h"
+#include "Error.h"
+#include "Path.h"
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstddef>
+
+namespace matryoshka::data {
+/**
+ * Imports many local files into a file system. Reader threads load and hash the files ahead into a bounded buffer,
+ * while the calling thread writes them in batches. Slow sources like network shares are thereby read while SQLite
+ * writes, which is the only work left on the calling thread.
+ */
+class Importer {
+ public:
+  using SizeType = FileSystem::SizeType;
+
+  // A buffer large enough to keep the writer busy while readers wait for slow storage.
+  constexpr static SizeType DEFAULT_BUFFER_SIZE = 64 * 1024 * 1024;
+
+  // A local file and the path it is imported to.
+  struct Job {
+	Path path;
+	std::string file_path;
+  };
+
+  struct Options {
+	// The number of threads reading local files.
+	std::size_t num_readers;
+	// The maximal number of bytes read, but not written yet. Larger files are streamed by the writer on its own.
+	SizeType buffer_size;
+	// The number of files committed together.
+	int batch_size;
+	// The proposed chunk size. Negative values let the file system choose.
+	int chunk_size;
+  };
+
+  // The outcome of an import.
+  struct Summary {
+	int num_imported, num_failed;
+  };
+
+  using FailureCallback = std::function<void(const Job &, const Error &)>;
+
+  Importer(FileSystem *file_system, const Options &options) noexcept;
+
+  /**
+   * Import the files, skipping the ones which could not be read or written.
+   * @param jobs The local files and their paths in the file system.
+   * @param on_failure Called on the calling thread for each file skipped, if set.
+   * @return The number of files imported and skipped, or an error if a batch could not be committed.
+   */
+  Result<Summary> Import(const std::vector<Job> &jobs, const FailureCallback &on_failure = nullptr);
+
+ private:
+  // A file loaded by a reader, or only stated if it is streamed by the writer.
+  struct Loaded {
+	std::size_t job;
+	SizeType size;
+	std::optional<FileSystem::Chunk> data;
+	util::Sha256::Digest digest;
+	std::optional<Error> error;
+  };
+
+  static Loaded Load(const Job &job, std::size_t index, SizeType size);
+
+  FileSystem *file_system_;
+  Options options_;
+};
+}
+
+#endif //MATRYOSHKA_MATRYOSHKA_DATA_IMPORTER_H_
@@ -38,6 +38,10 @@ Path::Path(std::string_view path) : parts_() {
 
 Path::Path(Path &&other) noexcept: parts_(std::move(other.parts_)) {}
 
+Path Path::Parent() const {
+  return parts_.empty() ? Path("") : Path(this->AbsolutePath(static_cast<int>(parts_.size()) - 1));
+}
+
 std::string Path::AbsolutePath(int parts) const {
   std::string result_path;
   result_path.reserve(std::accumulate(parts_.begin(), parts_.end(), std::size_t(0),
@@ -24,6 +24,12 @@ class Path {
 
   [[nodiscard]] std::string AbsolutePath(int parts = -1) const;
 
+  /**
+   * Get the path of the containing folder.
+   * @return The path without its last part, which is empty for entries of the root.
+   */
+  [[nodiscard]] Path Parent() const;
+
   inline explicit operator bool() const noexcept {
 	return !parts_.empty();
   }
@@ -10,6 +10,7 @@ You should have received a copy of the GNU Affero General Public License along w
 #define MATRYOSHKA_MATRYOSHKA_DATA_SQLITE_BLOB_H_
 
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
 
@@ -17,9 +18,11 @@ namespace matryoshka::data::sqlite {
 
 class BlobBase {
  public:
+  using SizeType = std::int_fast64_t;
+
   [[nodiscard]] virtual const unsigned char *Data() const noexcept = 0;
 
-  [[nodiscard]] inline int Size() const noexcept {
+  [[nodiscard]] inline SizeType Size() const noexcept {
 	return size_;
   }
 
@@ -31,7 +34,7 @@ class BlobBase {
 	return this->Data();
   }
 
-  [[nodiscard]] const unsigned char &operator[](int index) const noexcept {
+  [[nodiscard]] const unsigned char &operator[](SizeType index) const noexcept {
 	return this->Data()[index];
   }
 
@@ -65,8 +68,8 @@ class BlobBase {
   }
 
  protected:
-  constexpr explicit BlobBase(int size) noexcept: size_(size) {}
-  int size_;
+  constexpr explicit BlobBase(SizeType size) noexcept: size_(size) {}
+  SizeType size_;
 };
 
 template<bool HasOwnership>
@@ -75,12 +78,17 @@ class Blob {};
 template<>
 class Blob<false> : public BlobBase {
  public:
-  constexpr inline Blob(const unsigned char *data, int size) noexcept: BlobBase(size), data_(data) {}
+  constexpr inline Blob(const unsigned char *data, SizeType size) noexcept: BlobBase(size), data_(data) {}
 
   [[nodiscard]] inline const unsigned char *Data() const noexcept final {
 	return data_;
   }
 
+  [[nodiscard]] inline Blob<false> Part(SizeType length, SizeType onset = 0) const {
+	assert(onset + length <= size_);
+	return Blob<false>(&data_[onset], length);
+  }
+
  protected:
   const unsigned char *data_;
 };
@@ -90,9 +98,9 @@ class Blob<true> : public BlobBase {
  public:
   constexpr explicit Blob() noexcept: BlobBase(0), data_(nullptr) {}
 
-  inline explicit Blob(int size) : BlobBase(size), data_(new unsigned char[size]) {}
+  inline explicit Blob(SizeType size) : BlobBase(size), data_(new unsigned char[size]) {}
 
-  constexpr Blob(unsigned char *data, int size) noexcept: BlobBase(size), data_(data) {}
+  constexpr Blob(unsigned char *data, SizeType size) noexcept: BlobBase(size), data_(data) {}
 
   inline explicit Blob(const Blob<false> &shared) : BlobBase(shared.Size()), data_(new unsigned char[shared.Size()]) {
 	if (data_ && shared) {
@@ -100,12 +108,12 @@ class Blob<true> : public BlobBase {
 	}
   }
 
-  explicit Blob(std::string_view path, int maximal_size = -1) : BlobBase(0), data_(nullptr) {
+  explicit Blob(std::string_view path, SizeType maximal_size = -1) : BlobBase(0), data_(nullptr) {
 	std::ifstream file(path.data(), std::ifstream::in | std::ifstream::binary);
 	if (file) {
 	  // Get file length
 	  file.seekg(0, std::ifstream::end);
-	  int length = file.tellg();
+	  SizeType length = file.tellg();
 	  file.seekg(0, std::ifstream::beg);
 
 	  // Enforce maximal size
@@ -147,7 +155,7 @@ class Blob<true> : public BlobBase {
 	return result;
   }
 
-  [[nodiscard]] inline Blob<false> Part(int length, int onset = 0) {
+  [[nodiscard]] inline Blob<false> Part(SizeType length, SizeType onset = 0) {
 	assert(onset + length <= size_);
 	return Blob<false>(&data_[onset], length);
   }
@@ -170,11 +178,20 @@ class Blob<true> : public BlobBase {
 	return tmp;
   }
 
-  [[nodiscard]] unsigned char &operator[](int index) noexcept {
+  [[nodiscard]] unsigned char &operator[](SizeType index) noexcept {
 	return data_[index];
   }
 
-  bool Set(int onset, BlobBase *other, int length = -1, int other_onset = 0) {
+  /**
+   * Reduce the size without reallocating. The memory beyond is only freed with the whole blob.
+   * @param size The new size, which must not exceed the current one.
+   */
+  inline void Shrink(SizeType size) noexcept {
+	assert(size >= 0 && size <= size_);
+	size_ = size;
+  }
+
+  bool Set(SizeType onset, BlobBase *other, SizeType length = -1, SizeType other_onset = 0) {
 	if (onset < 0 || other_onset < 0 || onset >= this->Size() || other == nullptr) {
 	  return false;
 	} else if (length <= 0) {
@@ -196,7 +213,7 @@ class Blob<true> : public BlobBase {
 	return Blob<false>(data_, size_);
   }
 
-  static Blob<true> Filled(int num_bytes, unsigned char value = 0) {
+  static Blob<true> Filled(SizeType num_bytes, unsigned char value = 0) {
 	Blob<true> data(new unsigned char[num_bytes], num_bytes);
 	std::fill_n(data.Data(), num_bytes, value);
 	return data;
@@ -69,7 +69,16 @@ Blob<true> BlobReader::Read(int length, int offset) const {
   }
 }
 
-Status BlobReader::Read(Blob<true> &destination, int offset, int destination_offset, int num_bytes) const {
+Status BlobReader::Read(unsigned char *destination, int offset, int num_bytes) const {
+  assert(offset >= 0);
+  assert(offset + num_bytes <= this->Size());
+  return Status(sqlite3_blob_read(handle_, static_cast<void *>(destination), num_bytes, offset));
+}
+
+Status BlobReader::Read(Blob<true> &destination,
+						int offset,
+						Blob<true>::SizeType destination_offset,
+						int num_bytes) const {
   assert(offset >= 0);
   assert(destination_offset >= 0);
   assert(offset + num_bytes <= this->Size());
@@ -79,7 +88,7 @@ Status BlobReader::Read(Blob<true> &destination, int offset, int destination_off
   return Status(sqlite3_blob_read(
 	  handle_,
 	  static_cast<void *>(&data[destination_offset]),
-	  num_bytes <= 0 ? destination.Size() - destination_offset : num_bytes,
+	  num_bytes <= 0 ? static_cast<int>(destination.Size() - destination_offset) : num_bytes,
 	  offset)
   );
 }
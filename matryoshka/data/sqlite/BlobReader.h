@@ -31,13 +31,16 @@ class BlobReader {
   BlobReader &operator=(BlobReader const &) = delete;
 
   [[nodiscard]] int Size() const noexcept;
-  Status Read(Blob<true> &destination, int offset = 0, int destination_offset = 0, int num_bytes = -1) const;
+  Status Read(Blob<true> &destination,
+			  int offset = 0,
+			  Blob<true>::SizeType destination_offset = 0,
+			  int num_bytes = -1) const;
   [[nodiscard]] Blob<true> Read(int length, int offset = 0) const;
+  Status Read(unsigned char *destination, int offset, int num_bytes) const;
 
  protected:
   explicit constexpr BlobReader(sqlite3_blob *handle) noexcept: handle_(handle) {}
 
- private:
   sqlite3_blob *handle_;
 };
 }
@@ -0,0 +1,55 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "BlobWriter.h"
+
+#include <sqlite3.h>
+#include <cassert>
+
+namespace matryoshka::data::sqlite {
+
+Result<BlobWriter> BlobWriter::Open(const Database &database,
+									Database::RowId blob_id,
+									std::string_view table,
+									std::string_view column) noexcept {
+  sqlite3_blob *handle;
+  const auto status = Status(sqlite3_blob_open(
+	  database.Raw(),
+	  "main",
+	  table.data(),
+	  column.data(),
+	  blob_id,
+	  1,
+	  &handle));
+
+  if (status) {
+	return Result<BlobWriter>(BlobWriter(handle));
+  } else {
+	return Result<BlobWriter>(status);
+  }
+}
+
+Result<BlobWriter> BlobWriter::Open(BlobWriter &&old_handle, Database::RowId blob_id) noexcept {
+  const auto status = Status(sqlite3_blob_reopen(old_handle.handle_, blob_id));
+  if (status) {
+	sqlite3_blob *handle = old_handle.handle_;
+	assert(handle != nullptr);
+	old_handle.handle_ = nullptr;
+	return Result<BlobWriter>(BlobWriter(handle));
+  } else {
+	return Result<BlobWriter>(status);
+  }
+}
+
+Status BlobWriter::Write(const unsigned char *source, int offset, int num_bytes) {
+  assert(offset >= 0);
+  assert(offset + num_bytes <= this->Size());
+  return Status(sqlite3_blob_write(handle_, static_cast<const void *>(source), num_bytes, offset));
+}
+
+}
\ No newline at end of file
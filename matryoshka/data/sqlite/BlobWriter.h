@@ -0,0 +1,37 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_MATRYOSHKA_DATA_SQLITE_BLOBWRITER_H_
+#define MATRYOSHKA_MATRYOSHKA_DATA_SQLITE_BLOBWRITER_H_
+
+#include "BlobReader.h"
+
+namespace matryoshka::data::sqlite {
+/**
+ * A blob opened for writing. The size of the blob is fixed, so only existing bytes may be overwritten.
+ */
+class BlobWriter : public BlobReader {
+ public:
+  static Result<BlobWriter> Open(const Database &database,
+								 Database::RowId blob_id,
+								 std::string_view table,
+								 std::string_view column) noexcept;
+  static Result<BlobWriter> Open(BlobWriter &&old_handle, Database::RowId blob_id) noexcept;
+
+  BlobWriter(BlobWriter &&other) noexcept = default;
+  BlobWriter(BlobWriter const &) = delete;
+  BlobWriter &operator=(BlobWriter const &) = delete;
+
+  Status Write(const unsigned char *source, int offset, int num_bytes);
+
+ protected:
+  explicit constexpr BlobWriter(sqlite3_blob *handle) noexcept: BlobReader(handle) {}
+};
+}
+
+#endif //MATRYOSHKA_MATRYOSHKA_DATA_SQLITE_BLOBWRITER_H_
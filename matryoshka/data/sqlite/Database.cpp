@@ -12,6 +12,7 @@ You should have received a copy of the GNU Affero General Public License along w
 #include <sqlite3.h>
 
 #include <cassert>
+#include <string>
 
 namespace matryoshka::data::sqlite {
 
@@ -20,10 +21,11 @@ Database::Database(sqlite3 *database) noexcept: database_(database) {
   sqlite3_extended_result_codes(database_, true);
 }
 
-Result<Database> Database::Create(std::string_view path) noexcept {
+Result<Database> Database::Create(std::string_view path, const Options &options) noexcept {
   sqlite3 *database;
 
-  auto status = Status(sqlite3_open_v2(path.data(), &database, SQLITE_OPEN_READWRITE, nullptr)
+  const int flags = options.read_only ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE;
+  auto status = Status(sqlite3_open_v2(path.data(), &database, flags, nullptr)
   ).Than([database] {
 	return Status(sqlite3_db_config(database, SQLITE_DBCONFIG_ENABLE_FKEY, 1, nullptr));
   }).Than([database] {
@@ -31,7 +33,12 @@ Result<Database> Database::Create(std::string_view path) noexcept {
   });
 
   if (status) {
-	return Result<Database>(Database(database));
+	Database result(database);
+	status = result.Apply(options);
+	if (status) {
+	  return Result<Database>(std::move(result));
+	}
+	return Result<Database>(status);
   } else {
 	sqlite3_close_v2(database);
 	return Result<Database>(status);
@@ -82,4 +89,79 @@ Database::RowId Database::LastInsertedRow() const noexcept {
   return sqlite3_last_insert_rowid(database_);
 }
 
+bool Database::IsInTransaction() const noexcept {
+  return database_ != nullptr && sqlite3_get_autocommit(database_) == 0;
+}
+
+std::string_view Database::Path() const noexcept {
+  const char *path = sqlite3_db_filename(database_, "main");
+  return path != nullptr ? std::string_view(path) : std::string_view();
+}
+
+Status Database::Apply(const Options &options) noexcept {
+  // The page size must be set before switching to WAL, which fixes it.
+  static constexpr std::string_view JOURNAL_MODES[] = {"", "DELETE", "WAL"};
+  Status status;
+  if (options.busy_timeout >= 0) {
+	status = Status(sqlite3_busy_timeout(database_, options.busy_timeout));
+  }
+  if (status && options.page_size > 0) {
+	status = (*this)("PRAGMA page_size = " + std::to_string(options.page_size));
+  }
+  if (status && options.journal != Options::Journal::Keep) {
+	status = (*this)(std::string("PRAGMA journal_mode = ").append(JOURNAL_MODES[static_cast<int>(options.journal)]));
+  }
+  if (status && options.synchronous >= 0) {
+	status = (*this)("PRAGMA synchronous = " + std::to_string(options.synchronous));
+  }
+  if (status && options.cache_size.has_value()) {
+	status = (*this)("PRAGMA cache_size = " + std::to_string(options.cache_size.value()));
+  }
+  if (status && options.mmap_size >= 0) {
+	status = (*this)("PRAGMA mmap_size = " + std::to_string(options.mmap_size));
+  }
+  return status;
+}
+
+Database::Options Database::Options::BulkImport() noexcept {
+  Options options;
+  options.journal = Journal::Delete;
+  options.synchronous = 0;
+  options.page_size = 16384;
+  options.cache_size = -256 * 1024;
+  options.mmap_size = 0;
+  return options;
+}
+
+Database::Options Database::Options::ReadMostly() noexcept {
+  Options options;
+  options.journal = Journal::Wal;
+  options.synchronous = 1;
+  options.page_size = 16384;
+  options.cache_size = -64 * 1024;
+  options.mmap_size = std::int_fast64_t(1) << 30;
+  return options;
+}
+
+Database::Options Database::Options::Durable() noexcept {
+  Options options;
+  options.journal = Journal::Delete;
+  options.synchronous = 2;
+  options.mmap_size = 0;
+  return options;
+}
+
+std::optional<Database::Options> Database::Options::Preset(std::string_view name) noexcept {
+  if (name == "default") {
+	return Options();
+  } else if (name == "bulk-import") {
+	return Options::BulkImport();
+  } else if (name == "read-mostly") {
+	return Options::ReadMostly();
+  } else if (name == "durable") {
+	return Options::Durable();
+  }
+  return std::nullopt;
+}
+
 }
\ No newline at end of file
@@ -12,6 +12,8 @@ You should have received a copy of the GNU Affero General Public License along w
 #include "Result.h"
 
 #include <string_view>
+#include <optional>
+#include <cstdint>
 
 class sqlite3;
 
@@ -20,13 +22,55 @@ class Database {
  public:
   using RowId = std::int_fast64_t;
 
-  static Result<Database> Create(std::string_view path = ":memory:") noexcept;
+  /**
+   * The tuning applied when opening a database. Negative values keep the defaults of SQLite.
+   */
+  struct Options {
+	enum class Journal { Keep, Delete, Wal };
+
+	Journal journal = Journal::Keep;
+	// 0 = OFF, 1 = NORMAL, 2 = FULL
+	int synchronous = -1;
+	// The page size is only changeable before the first table is created.
+	int page_size = -1;
+	// Positive values count pages, negative ones are a negated size in KiB. The latter is not kept.
+	std::optional<int> cache_size;
+	std::int_fast64_t mmap_size = -1;
+	// Open the database without the permission to change it.
+	bool read_only = false;
+	// The milliseconds to wait for a lock held by another connection before failing as busy. 0 fails immediately.
+	int busy_timeout = 5000;
+
+	// Fast writing of many files, at the risk of a corrupted database on power loss.
+	static Options BulkImport() noexcept;
+	// Concurrent readers alongside a single writer, with reads served from memory-mapped pages.
+	static Options ReadMostly() noexcept;
+	// Every transaction is on disk once committed.
+	static Options Durable() noexcept;
+
+	/**
+	 * Look up a preset by its name, i.e. "default", "bulk-import", "read-mostly" or "durable".
+	 * @param name The name of the preset.
+	 * @return The preset, if the name is known.
+	 */
+	static std::optional<Options> Preset(std::string_view name) noexcept;
+  };
+
+  static Result<Database> Create(std::string_view path, const Options &options) noexcept;
+  static inline Result<Database> Create(std::string_view path = ":memory:") noexcept {
+	return Database::Create(path, Options());
+  }
   Database(Database &&other) noexcept;
   ~Database() noexcept;
   Database(Database const &) = delete;
   Database &operator=(Database const &) = delete;
 
   [[nodiscard]] RowId LastInsertedRow() const noexcept;
+  // Whether a transaction was begun and is neither committed nor rolled back yet.
+  [[nodiscard]] bool IsInTransaction() const noexcept;
+  // The file of the database, which is empty for in-memory databases.
+  [[nodiscard]] std::string_view Path() const noexcept;
+  Status Apply(const Options &options) noexcept;
 
   [[nodiscard]] int MaximalDataSize() const noexcept;
   bool SetMaximalDataSize(int new_size) noexcept;
@@ -46,7 +46,7 @@ class PreparedStatement {
 	if (prepared_statement_ == nullptr) {
 	  return Status(1);
 	}
-	// ToDo: Insert mutex here to restrict concurrent access on single prepared statement
+	// A statement is not shared between threads, concurrent readers use their own connection (see FileSystemPool)
 	Query query(prepared_statement_);
 	return callback(query);
   }
@@ -52,16 +52,31 @@ Status Query::Set(int index, double value) noexcept {
 
 Status Query::Set(int index, Blob<true> &&value) {
   // Unique pointer is used for indicating the shifted ownership
-  return Status(sqlite3_bind_blob(prepared_statement_, index + 1, value.Release(), value.Size(), &Query::_deleteBlob));
+  const auto size = static_cast<sqlite3_uint64>(value.Size());
+  return Status(sqlite3_bind_blob64(prepared_statement_, index + 1, value.Release(), size, &Query::_deleteBlob));
+}
+
+Status Query::SetZeroBlob(int index, Blob<true>::SizeType size) noexcept {
+  // The blob is allocated in the database only, its content may be written incrementally afterwards
+  return Status(sqlite3_bind_zeroblob64(prepared_statement_, index + 1, static_cast<sqlite3_uint64>(size)));
 }
 
 Status Query::Set(int index, const Blob<false> &value) {
   // Unique pointer is used for indicating the shifted ownership
-  return Status(sqlite3_bind_blob(prepared_statement_,
-								  index + 1,
-								  static_cast<const unsigned char *>(value),
-								  value.Size(),
-								  SQLITE_TRANSIENT));
+  return Status(sqlite3_bind_blob64(prepared_statement_,
+									index + 1,
+									static_cast<const unsigned char *>(value),
+									static_cast<sqlite3_uint64>(value.Size()),
+									SQLITE_TRANSIENT));
+}
+
+Status Query::SetView(int index, const Blob<false> &value) noexcept {
+  // SQLite reads the data only while stepping the statement, which the caller keeps it alive for
+  return Status(sqlite3_bind_blob64(prepared_statement_,
+									index + 1,
+									static_cast<const unsigned char *>(value),
+									static_cast<sqlite3_uint64>(value.Size()),
+									SQLITE_STATIC));
 }
 
 int Query::NumParameter() const noexcept {
@@ -84,6 +99,10 @@ int Query::GetInteger(int index) const {
   return sqlite3_column_int(prepared_statement_, index);
 }
 
+std::int_fast64_t Query::GetInteger64(int index) const {
+  return sqlite3_column_int64(prepared_statement_, index);
+}
+
 std::string_view Query::GetText(int index) const {
   return std::string_view(reinterpret_cast<const char *>(sqlite3_column_text(prepared_statement_, index)),
 						  sqlite3_column_bytes(
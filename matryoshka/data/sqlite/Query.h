@@ -55,6 +55,14 @@ class Query {
   Status Set(int index, double value) noexcept;
   Status Set(int index, Blob<true> &&value);
   Status Set(int index, const Blob<false> &value);
+  /**
+   * Bind data without copying it. The data needs to stay valid until the query was executed.
+   * @param index The index of the parameter.
+   * @param value The data bound.
+   * @return The status of the binding.
+   */
+  Status SetView(int index, const Blob<false> &value) noexcept;
+  Status SetZeroBlob(int index, Blob<true>::SizeType size) noexcept;
 
   template<typename T>
   inline Status SetByName(std::string_view name, T value) noexcept {
@@ -88,10 +96,12 @@ class Query {
  protected:
   [[nodiscard]] double GetDouble(int index) const;
   [[nodiscard]] int GetInteger(int index) const;
+  [[nodiscard]] std::int_fast64_t GetInteger64(int index) const;
   [[nodiscard]] std::string_view GetText(int index) const;
   [[nodiscard]] Blob<false> GetData(int index) const;
 
   friend class values::Value<int>;
+  friend class values::Value<std::int_fast64_t>;
   friend class values::Value<double>;
   friend class values::Value<std::string_view>;
   friend class values::Value<Blob<false>>;
@@ -116,6 +126,13 @@ struct Value<int> : std::true_type {
   }
 };
 
+template<>
+struct Value<std::int_fast64_t> : std::true_type {
+  [[nodiscard]] static inline std::int_fast64_t Read(const Query *query, int index) {
+	return query->GetInteger64(index);
+  }
+};
+
 template<>
 struct Value<double> : std::true_type {
   [[nodiscard]] static inline double Read(const Query *query, int index) {
@@ -17,22 +17,45 @@ namespace matryoshka::data::sqlite {
 
 Result<Transaction> Transaction::Open(Database *database) noexcept {
   assert(database != nullptr);
-  const Status status = (*database)("BEGIN;");
+  const bool is_nested = database->IsInTransaction();
+  const Status status = (*database)(is_nested ? "SAVEPOINT matryoshka;" : "BEGIN;");
   if (status.IsSuccessful()) {
-	return Result<Transaction>(Transaction(database));
+	return Result<Transaction>(Transaction(database, is_nested));
   } else {
 	return Result<Transaction>(status);
   }
 }
 
-Transaction::Transaction(Transaction &&other) noexcept: database_(other.database_) {
+Transaction::Transaction(Transaction &&other) noexcept: database_(other.database_), is_nested_(other.is_nested_) {
   other.database_ = nullptr;
 }
 
+Status Transaction::Commit() noexcept {
+  if (database_ == nullptr) {
+	return Status();
+  }
+
+  const Status status = (*database_)(is_nested_ ? "RELEASE matryoshka;" : "COMMIT;");
+  if (status) {
+	database_ = nullptr;
+  }
+  return status;
+}
+
 Transaction::~Transaction() noexcept {
   this->Rollback();
 }
 
+Status Transaction::Rollback() noexcept {
+  // A savepoint stays on the stack after rolling back to it and needs to be released afterwards
+  if (is_nested_ && database_ != nullptr) {
+	const Status status = (*database_)("ROLLBACK TO matryoshka;");
+	const Status release_status = this->_callDatabase("RELEASE matryoshka;");
+	return status ? release_status : status;
+  }
+  return this->_callDatabase("ROLLBACK;");
+}
+
 Status Transaction::_callDatabase(std::string_view command) noexcept {
   if (database_ == nullptr) {
 	return Status();
@@ -16,12 +16,24 @@ class Database;
 
 class Transaction {
  public:
+  /**
+   * Begin a transaction. Within an already open transaction, a savepoint is set instead, so the changes of this
+   * transaction are undone on their own and only become durable with the outer one.
+   * @param database The database, which must outlive the transaction.
+   * @return The transaction, which is rolled back unless committed.
+   */
   static Result<Transaction> Open(Database *database) noexcept;
-  inline Status Commit() noexcept {
-	return this->_callDatabase("COMMIT;");
-  }
-  Status Rollback() noexcept {
-	return this->_callDatabase("ROLLBACK;");
+
+  /**
+   * Make the changes durable. A failed commit leaves the transaction open, so it is still rolled back explicitly or
+   * on destruction.
+   * @return The status of the commit.
+   */
+  Status Commit() noexcept;
+  Status Rollback() noexcept;
+
+  [[nodiscard]] inline bool IsNested() const noexcept {
+	return is_nested_;
   }
 
   ~Transaction() noexcept;
@@ -30,12 +42,13 @@ class Transaction {
   Transaction &operator=(Transaction const &) = delete;
 
  protected:
-  constexpr explicit Transaction(Database *database) noexcept: database_(database) {}
+  constexpr Transaction(Database *database, bool is_nested) noexcept: database_(database), is_nested_(is_nested) {}
 
  private:
   Status _callDatabase(std::string_view command) noexcept;
 
   Database *database_;
+  bool is_nested_;
 };
 }
 
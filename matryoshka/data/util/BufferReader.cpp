@@ -0,0 +1,48 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "BufferReader.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace matryoshka::data::util {
+
+BufferReader::BufferReader(const Buffer *buffers, std::size_t num_buffers, SizeType start)
+	: Reader(start), buffers_(buffers), num_buffers_(num_buffers), buffer_index_(0), length_(0), buffer_offset_(0) {
+  for (std::size_t i = 0; i < num_buffers_; ++i) {
+	length_ += buffers_[i].size;
+  }
+}
+
+Reader::SizeType BufferReader::Length() const noexcept {
+  return length_;
+}
+
+sqlite::Status BufferReader::HandleBlob(sqlite::BlobReader &blob, int blob_offset, SizeType, int num_bytes) {
+  sqlite::Status status;
+  while (status && num_bytes > 0) {
+	// Skip the buffers already filled
+	while (buffer_index_ < num_buffers_ && buffer_offset_ == buffers_[buffer_index_].size) {
+	  ++buffer_index_;
+	  buffer_offset_ = 0;
+	}
+	assert(buffer_index_ < num_buffers_);
+
+	const Buffer &buffer = buffers_[buffer_index_];
+	const int bytes_to_read = static_cast<int>(std::min<SizeType>(buffer.size - buffer_offset_, num_bytes));
+	status = this->Copy(blob, static_cast<unsigned char *>(buffer.data) + buffer_offset_, blob_offset, bytes_to_read);
+
+	blob_offset += bytes_to_read;
+	buffer_offset_ += bytes_to_read;
+	num_bytes -= bytes_to_read;
+  }
+  return status;
+}
+
+}
\ No newline at end of file
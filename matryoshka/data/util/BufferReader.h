@@ -0,0 +1,40 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_MATRYOSHKA_DATA_UTIL_BUFFERREADER_H_
+#define MATRYOSHKA_MATRYOSHKA_DATA_UTIL_BUFFERREADER_H_
+
+#include "Reader.h"
+
+#include <cstddef>
+
+namespace matryoshka::data::util {
+/**
+ * A reader writing the chunks directly into memory owned by the caller, scattered over multiple buffers.
+ */
+class BufferReader : public Reader {
+ public:
+  struct Buffer {
+	void *data;
+	SizeType size;
+  };
+
+  BufferReader(const Buffer *buffers, std::size_t num_buffers, SizeType start = 0);
+  [[nodiscard]] SizeType Length() const noexcept override;
+
+ protected:
+  sqlite::Status HandleBlob(sqlite::BlobReader &blob, int blob_offset, SizeType bytes_read, int num_bytes) override;
+
+ private:
+  const Buffer *buffers_;
+  std::size_t num_buffers_, buffer_index_;
+  SizeType length_, buffer_offset_;
+};
+}
+
+#endif //MATRYOSHKA_MATRYOSHKA_DATA_UTIL_BUFFERREADER_H_
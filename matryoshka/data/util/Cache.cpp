@@ -14,7 +14,7 @@ Cache::Cache() noexcept: size_(0), current_index_(0) {
 
 }
 
-int Cache::Size() const noexcept {
+Cache::SizeType Cache::Size() const noexcept {
   return size_ - current_index_;
 }
 
@@ -24,19 +24,19 @@ bool Cache::IsEmpty() const noexcept {
 
 void Cache::Push(Cache::Chunk &&data) {
   size_ += data.Size();
-  cache_.push(std::move(data));
+  cache_.push_back(std::move(data));
 }
 
-Cache::Chunk Cache::Pop(int size) {
+Cache::Chunk Cache::Pop(SizeType size) {
   if (size <= 0 && size > this->Size()) {
 	return Cache::Chunk();
   }
 
   Chunk data(size);
-  int bytes_written = 0;
-  for (int chunk_onset = 0; bytes_written < size && !cache_.empty();) {
-	const int remaining_size = size - chunk_onset;
-	const int current_chunk_size = cache_.front().Size() - current_index_;
+  SizeType bytes_written = 0;
+  for (SizeType chunk_onset = 0; bytes_written < size && !cache_.empty();) {
+	const SizeType remaining_size = size - chunk_onset;
+	const SizeType current_chunk_size = cache_.front().Size() - current_index_;
 
 	// If the current blob in cache hold more than the required data
 	if (remaining_size < current_chunk_size) {
@@ -47,7 +47,7 @@ Cache::Chunk Cache::Pop(int size) {
 	} else {
 	  data.Set(chunk_onset, &cache_.front(), current_chunk_size, current_index_);
 	  size_ -= cache_.front().Size();
-	  cache_.pop();
+	  cache_.pop_front();
 	  current_index_ = 0;
 	  bytes_written += current_chunk_size;
 	  chunk_onset += current_chunk_size;
@@ -57,4 +57,26 @@ Cache::Chunk Cache::Pop(int size) {
   return data;
 }
 
+Cache::SizeType Cache::Find(Chunker &chunker) const noexcept {
+  // Continue after the bytes scanned already
+  SizeType onset = 0, skip = chunker.Position();
+  for (auto chunk = cache_.begin(); chunk != cache_.end(); ++chunk) {
+	const SizeType chunk_start = chunk == cache_.begin() ? current_index_ : 0;
+	const SizeType chunk_length = chunk->Size() - chunk_start;
+	if (skip >= chunk_length) {
+	  skip -= chunk_length;
+	  onset += chunk_length;
+	  continue;
+	}
+
+	const SizeType boundary = chunker.Update(chunk->Data() + chunk_start + skip, chunk_length - skip);
+	if (boundary >= 0) {
+	  return onset + skip + boundary;
+	}
+	onset += chunk_length;
+	skip = 0;
+  }
+  return 0;
+}
+
 }
\ No newline at end of file
@@ -10,31 +10,40 @@ You should have received a copy of the GNU Affero General Public License along w
 #define MATRYOSHKA_MATRYOSHKA_DATA_UTIL_CACHE_H_
 
 #include "../sqlite/Blob.h"
+#include "Chunker.h"
 
-#include <queue>
+#include <deque>
 
 namespace matryoshka::data::util {
 class Cache {
  public:
   using Chunk = sqlite::Blob<true>;
+  using SizeType = Chunk::SizeType;
 
   explicit Cache() noexcept;
   Cache(Cache const &) = delete;
   Cache &operator=(Cache const &) = delete;
   
-  [[nodiscard]] int Size() const noexcept;
+  [[nodiscard]] SizeType Size() const noexcept;
   [[nodiscard]] bool IsEmpty() const noexcept;
 
   void Push(Chunk &&data);
-  Chunk Pop(int size);
+  Chunk Pop(SizeType size);
+
+  /**
+   * Search the cached data for the end of the next content-defined chunk.
+   * @param chunker The chunker, which remembers the bytes already scanned in former calls.
+   * @return The length of the next chunk, or 0 if the cached data ends before a boundary.
+   */
+  SizeType Find(Chunker &chunker) const noexcept;
 
   inline explicit operator bool() const noexcept {
 	return !this->IsEmpty();
   }
 
  private:
-  std::queue<Chunk> cache_;
-  int size_, current_index_;
+  std::deque<Chunk> cache_;
+  SizeType size_, current_index_;
 };
 }
 
@@ -13,19 +13,20 @@ You should have received a copy of the GNU Affero General Public License along w
 
 namespace matryoshka::data::util {
 
-ChunkReader::ChunkReader(int length, ChunkReader::Callback callback, int start)
+ChunkReader::ChunkReader(SizeType length, ChunkReader::Callback callback, SizeType start)
 	: Reader(start), length_(length), callback_(std::move(callback)) {
   assert(length > 0);
 }
 
-int ChunkReader::Length() const noexcept {
+Reader::SizeType ChunkReader::Length() const noexcept {
   return length_;
 }
 
-sqlite::Status ChunkReader::HandleBlob(sqlite::BlobReader &blob, int blob_offset, int bytes_read, int num_bytes) {
+sqlite::Status ChunkReader::HandleBlob(sqlite::BlobReader &blob, int blob_offset, SizeType bytes_read, int num_bytes) {
   sqlite::Blob<true> data(num_bytes);
-  blob.Read(data, blob_offset, 0, num_bytes);
-  return callback_(std::move(data));
+  return this->Copy(blob, data.Data(), blob_offset, num_bytes).Than([&]() {
+	return callback_(std::move(data));
+  });
 }
 
 }
\ No newline at end of file
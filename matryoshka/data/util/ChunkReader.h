@@ -18,15 +18,15 @@ class ChunkReader : public Reader {
  public:
   using Callback = std::function<sqlite::Status(sqlite::Blob<true> &&)>;
 
-  ChunkReader(int length, Callback callback, int start = 0);
-  [[nodiscard]] int Length() const noexcept override;
+  ChunkReader(SizeType length, Callback callback, SizeType start = 0);
+  [[nodiscard]] SizeType Length() const noexcept override;
 
  protected:
-  sqlite::Status HandleBlob(sqlite::BlobReader &blob, int blob_offset, int bytes_read, int num_bytes) override;
+  sqlite::Status HandleBlob(sqlite::BlobReader &blob, int blob_offset, SizeType bytes_read, int num_bytes) override;
 
  private:
   Callback callback_;
-  int length_;
+  SizeType length_;
 };
 }
 
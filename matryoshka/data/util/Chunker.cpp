@@ -0,0 +1,90 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Chunker.h"
+
+#include <array>
+#include <algorithm>
+#include <cassert>
+
+namespace matryoshka::data::util {
+
+namespace {
+// The table must never change, as it defines where the boundaries of stored files are.
+constexpr std::array<std::uint64_t, 256> CreateGearTable() noexcept {
+  std::array<std::uint64_t, 256> table{};
+  std::uint64_t state = 0x4d6174727966736bu;
+  for (std::size_t i = 0; i < table.size(); ++i) {
+	// SplitMix64
+	state += 0x9e3779b97f4a7c15u;
+	std::uint64_t value = state;
+	value = (value ^ (value >> 30u)) * 0xbf58476d1ce4e5b9u;
+	value = (value ^ (value >> 27u)) * 0x94d049bb133111ebu;
+	table[i] = value ^ (value >> 31u);
+  }
+  return table;
+}
+
+constexpr std::array<std::uint64_t, 256> GEAR = CreateGearTable();
+
+// The highest bits of the hash depend on the most bytes, so they are used for finding boundaries
+constexpr std::uint64_t HighBits(int num_bits) noexcept {
+  return num_bits <= 0 ? 0 : ~std::uint64_t(0) << static_cast<unsigned int>(64 - num_bits);
+}
+}
+
+Chunker::Chunker(const Parameters &parameters) noexcept
+	: parameters_(parameters),
+	  mask_small_(0),
+	  mask_large_(0),
+	  hash_(0),
+	  position_(0) {
+  assert(0 < parameters.minimal_size && parameters.minimal_size <= parameters.average_size
+			 && parameters.average_size <= parameters.maximal_size);
+
+  // Below the average size, boundaries are less likely; above, more likely
+  int num_bits = 0;
+  while ((1 << (num_bits + 1)) <= parameters.average_size) {
+	++num_bits;
+  }
+  mask_small_ = HighBits(num_bits + 1);
+  mask_large_ = HighBits(num_bits - 1);
+}
+
+Chunker::SizeType Chunker::Update(const unsigned char *data, SizeType length) noexcept {
+  SizeType i = 0;
+  while (i < length) {
+	// Boundaries below the minimal size are never used, so skip hashing those bytes
+	if (position_ < parameters_.minimal_size) {
+	  const SizeType skip = std::min<SizeType>(parameters_.minimal_size - position_, length - i);
+	  position_ += skip;
+	  i += skip;
+	} else {
+	  hash_ = (hash_ << 1u) + GEAR[data[i++]];
+	  ++position_;
+	  const std::uint64_t mask = position_ < parameters_.average_size ? mask_small_ : mask_large_;
+	  if ((hash_ & mask) == 0) {
+		this->Reset();
+		return i;
+	  }
+	}
+
+	if (position_ >= parameters_.maximal_size) {
+	  this->Reset();
+	  return i;
+	}
+  }
+  return -1;
+}
+
+void Chunker::Reset() noexcept {
+  hash_ = 0;
+  position_ = 0;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_MATRYOSHKA_DATA_UTIL_CHUNKER_H_
+#define MATRYOSHKA_MATRYOSHKA_DATA_UTIL_CHUNKER_H_
+
+#include "../sqlite/Blob.h"
+
+#include <cstdint>
+
+namespace matryoshka::data::util {
+/**
+ * A content-defined chunker using a Gear rolling hash with normalized chunking as proposed by FastCDC. As boundaries
+ * depend only on the preceding bytes, inserting data into a file shifts only the boundaries close to the insertion.
+ */
+class Chunker {
+ public:
+  using SizeType = sqlite::BlobBase::SizeType;
+
+  struct Parameters {
+	int minimal_size, average_size, maximal_size;
+
+	[[nodiscard]] static inline Parameters Create(int average_size) noexcept {
+	  return Parameters{average_size / 4, average_size, average_size * 8};
+	}
+  };
+
+  explicit Chunker(const Parameters &parameters) noexcept;
+
+  /**
+   * Scan the next bytes of the current chunk for a boundary.
+   * @param data The bytes following the ones scanned before.
+   * @param length The number of bytes.
+   * @return The number of bytes up to and including the boundary, or -1 if the chunk continues after the data.
+   */
+  SizeType Update(const unsigned char *data, SizeType length) noexcept;
+  void Reset() noexcept;
+
+  [[nodiscard]] inline SizeType Position() const noexcept {
+	return position_;
+  }
+
+  [[nodiscard]] inline int MaximalSize() const noexcept {
+	return parameters_.maximal_size;
+  }
+
+ private:
+  Parameters parameters_;
+  std::uint64_t mask_small_, mask_large_, hash_;
+  SizeType position_;
+};
+}
+
+#endif //MATRYOSHKA_MATRYOSHKA_DATA_UTIL_CHUNKER_H_
@@ -0,0 +1,256 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Codec.h"
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+namespace matryoshka::data::util {
+
+namespace {
+constexpr int LZ_HEADER_SIZE = 5;
+constexpr int MIN_MATCH = 4;
+constexpr int HASH_BITS = 14;
+constexpr Codec::SizeType MAX_OFFSET = 65535;
+
+inline std::uint32_t Read32(const unsigned char *data) noexcept {
+  std::uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+inline std::uint32_t Hash(std::uint32_t sequence) noexcept {
+  return (sequence * 2654435761u) >> (32u - HASH_BITS);
+}
+
+// Lengths exceeding a nibble are continued in bytes of 255 until a smaller byte follows
+inline unsigned char *WriteLength(unsigned char *output, Codec::SizeType length) noexcept {
+  for (; length >= 255; length -= 255) {
+	*output++ = 255;
+  }
+  *output++ = static_cast<unsigned char>(length);
+  return output;
+}
+
+inline bool ReadLength(const unsigned char *&input, const unsigned char *end, Codec::SizeType &length) noexcept {
+  unsigned char value;
+  do {
+	if (input >= end) {
+	  return false;
+	}
+	value = *input++;
+	length += value;
+  } while (value == 255);
+  return true;
+}
+}
+
+sqlite::Blob<true> Codec::Encode(Type type, const sqlite::BlobBase &data) {
+  assert(type == Type::Lz);
+  const SizeType size = data.Size();
+
+  // The compressed chunk must be smaller than the stored one to be worth the effort. Either way, the chunk is written
+  // into a single buffer large enough for storing it as it is.
+  sqlite::Blob<true> output(size + 1);
+  if (size > 0 && size <= UINT32_MAX && size + 1 > LZ_HEADER_SIZE) {
+	const SizeType compressed_size =
+		Codec::CompressLz(data.Data(), size, output.Data() + LZ_HEADER_SIZE, size + 1 - LZ_HEADER_SIZE);
+	if (compressed_size > 0) {
+	  output[0] = static_cast<unsigned char>(Method::Lz);
+	  for (int i = 0; i < 4; ++i) {
+		output[1 + i] = static_cast<unsigned char>(static_cast<std::uint32_t>(size) >> (8 * i));
+	  }
+	  output.Shrink(LZ_HEADER_SIZE + compressed_size);
+	  return output;
+	}
+  }
+
+  output[0] = static_cast<unsigned char>(Method::Stored);
+  if (size > 0) {
+	std::memcpy(output.Data() + 1, data.Data(), size);
+  }
+  return output;
+}
+
+sqlite::Status Codec::Decode(const unsigned char *data, SizeType size, sqlite::Blob<true> &output) {
+  if (size < 1) {
+	return sqlite::Status(SQLITE_CORRUPT);
+  }
+
+  SizeType output_size;
+  switch (static_cast<Method>(data[0])) {
+	case Method::Stored:output_size = size - 1;
+	  break;
+	case Method::Lz:
+	  if (size < LZ_HEADER_SIZE) {
+		return sqlite::Status(SQLITE_CORRUPT);
+	  }
+	  output_size = 0;
+	  for (int i = 0; i < 4; ++i) {
+		output_size |= static_cast<SizeType>(data[1 + i]) << (8 * i);
+	  }
+	  break;
+	default:return sqlite::Status(SQLITE_CORRUPT);
+  }
+
+  if (output.Size() != output_size || (!output && output_size > 0)) {
+	output = sqlite::Blob<true>(output_size);
+  }
+  if (static_cast<Method>(data[0]) == Method::Stored) {
+	if (output_size > 0) {
+	  std::memcpy(output.Data(), data + 1, output_size);
+	}
+	return sqlite::Status();
+  }
+  return Codec::DecompressLz(data + LZ_HEADER_SIZE, size - LZ_HEADER_SIZE, output.Data(), output_size)
+		 ? sqlite::Status() : sqlite::Status(SQLITE_CORRUPT);
+}
+
+sqlite::Status Codec::Decode(const sqlite::BlobReader &blob, sqlite::Blob<true> &output) {
+  const sqlite::Blob<true> data = blob.Read(blob.Size());
+  if (data.Size() != blob.Size() || !data) {
+	return sqlite::Status(SQLITE_CORRUPT);
+  }
+  return Codec::Decode(data.Data(), data.Size(), output);
+}
+
+sqlite::Status Codec::IsStored(const sqlite::BlobReader &blob, bool &is_stored) {
+  unsigned char method = 0;
+  if (blob.Size() < 1) {
+	return sqlite::Status(SQLITE_CORRUPT);
+  }
+  const sqlite::Status status = blob.Read(&method, 0, 1);
+  is_stored = static_cast<Method>(method) == Method::Stored;
+  return status;
+}
+
+Codec::SizeType Codec::CompressLz(const unsigned char *input,
+								  SizeType size,
+								  unsigned char *output,
+								  SizeType capacity) {
+  // Positions are stored with an offset of one, so zero marks an empty slot
+  std::uint32_t table[1u << HASH_BITS] = {};
+  const unsigned char *const output_start = output, *const output_end = output + capacity;
+  SizeType position = 0, anchor = 0;
+
+  auto emit = [&](SizeType literals, SizeType offset, SizeType match_length) {
+	// The worst case: token, the literal length, the literals, the offset and the match length
+	const SizeType required = 1 + literals / 255 + 1 + literals + 2 + match_length / 255 + 1;
+	if (output_end - output < required) {
+	  return false;
+	}
+
+	unsigned char *token = output++;
+	*token = static_cast<unsigned char>((literals < 15 ? literals : 15) << 4u);
+	if (literals >= 15) {
+	  output = WriteLength(output, literals - 15);
+	}
+	std::memcpy(output, input + anchor, literals);
+	output += literals;
+
+	if (match_length > 0) {
+	  *output++ = static_cast<unsigned char>(offset);
+	  *output++ = static_cast<unsigned char>(offset >> 8u);
+	  const SizeType length_code = match_length - MIN_MATCH;
+	  *token |= static_cast<unsigned char>(length_code < 15 ? length_code : 15);
+	  if (length_code >= 15) {
+		output = WriteLength(output, length_code - 15);
+	  }
+	}
+	return true;
+  };
+
+  while (position + MIN_MATCH <= size) {
+	const std::uint32_t sequence = Read32(input + position);
+	std::uint32_t &slot = table[Hash(sequence)];
+	const SizeType reference = static_cast<SizeType>(slot) - 1;
+	slot = static_cast<std::uint32_t>(position + 1);
+
+	if (reference < 0 || position - reference > MAX_OFFSET || Read32(input + reference) != sequence) {
+	  // Skip faster through data which does not compress
+	  position += 1 + ((position - anchor) >> 6);
+	  continue;
+	}
+
+	SizeType match_length = MIN_MATCH;
+	while (position + match_length < size && input[reference + match_length] == input[position + match_length]) {
+	  ++match_length;
+	}
+	if (!emit(position - anchor, position - reference, match_length)) {
+	  return 0;
+	}
+	position += match_length;
+	anchor = position;
+  }
+
+  // The last sequence consists of literals only
+  if (!emit(size - anchor, 0, 0)) {
+	return 0;
+  }
+  return output - output_start;
+}
+
+bool Codec::DecompressLz(const unsigned char *input,
+						 SizeType size,
+						 unsigned char *output,
+						 SizeType output_size) {
+  const unsigned char *const input_end = input + size;
+  unsigned char *const output_start = output, *const output_end = output + output_size;
+
+  while (input < input_end) {
+	const unsigned char token = *input++;
+
+	SizeType literals = token >> 4u;
+	if (literals == 15 && !ReadLength(input, input_end, literals)) {
+	  return false;
+	}
+	if (input_end - input < literals || output_end - output < literals) {
+	  return false;
+	}
+	std::memcpy(output, input, literals);
+	input += literals;
+	output += literals;
+
+	// Only the last sequence ends after its literals
+	if (input == input_end) {
+	  break;
+	} else if (input_end - input < 2) {
+	  return false;
+	}
+
+	const SizeType offset = input[0] | (input[1] << 8u);
+	input += 2;
+	if (offset == 0 || offset > output - output_start) {
+	  return false;
+	}
+
+	SizeType match_length = token & 0x0fu;
+	if (match_length == 15 && !ReadLength(input, input_end, match_length)) {
+	  return false;
+	}
+	match_length += MIN_MATCH;
+	if (output_end - output < match_length) {
+	  return false;
+	}
+
+	// Matches may overlap with the bytes they produce
+	const unsigned char *match = output - offset;
+	for (SizeType i = 0; i < match_length; ++i) {
+	  output[i] = match[i];
+	}
+	output += match_length;
+  }
+
+  return output == output_end;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_MATRYOSHKA_DATA_UTIL_CODEC_H_
+#define MATRYOSHKA_MATRYOSHKA_DATA_UTIL_CODEC_H_
+
+#include "../sqlite/Blob.h"
+#include "../sqlite/BlobReader.h"
+#include "../sqlite/Status.h"
+
+namespace matryoshka::data::util {
+/**
+ * The compression of single chunks. Every chunk of a compressed file starts with a byte naming the method used for
+ * it, so chunks which do not shrink are stored as they are.
+ */
+class Codec {
+ public:
+  using SizeType = sqlite::BlobBase::SizeType;
+
+  enum class Type : int {
+	// Chunks are stored as they are, without any header. This is the layout of uncompressed files.
+	Store = 0,
+	// A fast byte-oriented LZ77 variant, similar to LZ4.
+	Lz = 1
+  };
+
+  // The codec of a file is stored in the bits 4 to 7 of its flags.
+  static constexpr int FLAGS_OFFSET = 4;
+  static constexpr int FLAGS_MASK = 0xf << FLAGS_OFFSET;
+
+  [[nodiscard]] static inline Type FromFlags(int flags) noexcept {
+	return static_cast<Type>((flags & FLAGS_MASK) >> FLAGS_OFFSET);
+  }
+
+  [[nodiscard]] static inline int ToFlags(Type type) noexcept {
+	return (static_cast<int>(type) << FLAGS_OFFSET) & FLAGS_MASK;
+  }
+
+  /**
+   * Compress a chunk, or store it with a header only if it does not shrink.
+   * @param type The codec of the file. It must not be Type::Store.
+   * @param data The content of the chunk.
+   * @return The chunk as written into the database.
+   */
+  [[nodiscard]] static sqlite::Blob<true> Encode(Type type, const sqlite::BlobBase &data);
+
+  /**
+   * Decompress a whole chunk.
+   * @param data The chunk as written into the database.
+   * @param size The size of the chunk in the database.
+   * @param output The content of the chunk, which is reallocated if its size does not match.
+   * @return A failure, if the chunk is corrupted.
+   */
+  static sqlite::Status Decode(const unsigned char *data, SizeType size, sqlite::Blob<true> &output);
+  static sqlite::Status Decode(const sqlite::BlobReader &blob, sqlite::Blob<true> &output);
+
+  /**
+   * Check whether the content of a chunk is stored directly after the header byte.
+   * @param blob The chunk as written into the database.
+   * @param is_stored The result of the check.
+   * @return A failure, if the header could not be read.
+   */
+  static sqlite::Status IsStored(const sqlite::BlobReader &blob, bool &is_stored);
+
+ private:
+  enum class Method : unsigned char {
+	Stored = 0,
+	Lz = 1
+  };
+
+  static SizeType CompressLz(const unsigned char *input, SizeType size, unsigned char *output, SizeType capacity);
+  static bool DecompressLz(const unsigned char *input, SizeType size, unsigned char *output, SizeType output_size);
+};
+}
+
+#endif //MATRYOSHKA_MATRYOSHKA_DATA_UTIL_CODEC_H_
@@ -0,0 +1,119 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "ContentStore.h"
+#include "Sha256.h"
+
+#include <utility>
+
+using namespace matryoshka::data::sqlite;
+
+namespace matryoshka::data::util {
+
+ContentStore::ContentStore(sqlite::PreparedStatement &&lookup_statement,
+						   sqlite::PreparedStatement &&acquire_statement,
+						   sqlite::PreparedStatement &&insert_statement,
+						   sqlite::PreparedStatement &&statistics_statement) noexcept
+	: lookup_statement_(std::move(lookup_statement)),
+	  acquire_statement_(std::move(acquire_statement)),
+	  insert_statement_(std::move(insert_statement)),
+	  statistics_statement_(std::move(statistics_statement)) {
+
+}
+
+sqlite::Result<ContentStore> ContentStore::Prepare(sqlite::Database &database, const MetaTable &meta) {
+  static constexpr std::string_view SQL_LOOKUP = "SELECT content_id FROM {content} WHERE hash = ?";
+  static constexpr std::string_view SQL_ACQUIRE = "UPDATE {content} SET refs = refs + 1 WHERE content_id = ?";
+  static constexpr std::string_view SQL_INSERT = "INSERT INTO {content} (hash, refs, data) VALUES (?, 1, ?)";
+  static constexpr std::string_view SQL_STATISTICS =
+	  "SELECT COALESCE(SUM(refs), 0), COUNT(*), COALESCE(SUM(refs * LENGTH(data)), 0), COALESCE(SUM(LENGTH(data)), 0) FROM {content}";
+
+  auto lookup_statement = sqlite::PreparedStatement::Create(database, meta.Format(SQL_LOOKUP));
+  auto acquire_statement = sqlite::PreparedStatement::Create(database, meta.Format(SQL_ACQUIRE));
+  auto insert_statement = sqlite::PreparedStatement::Create(database, meta.Format(SQL_INSERT));
+  auto statistics_statement = sqlite::PreparedStatement::Create(database, meta.Format(SQL_STATISTICS));
+
+  const Status status = sqlite::Result<>::Check(lookup_statement, acquire_statement, insert_statement,
+												statistics_statement);
+  if (status) {
+	return sqlite::Result<ContentStore>(ContentStore(sqlite::Result<>::Get(std::move(lookup_statement)),
+													 sqlite::Result<>::Get(std::move(acquire_statement)),
+													 sqlite::Result<>::Get(std::move(insert_statement)),
+													 sqlite::Result<>::Get(std::move(statistics_statement))));
+  } else {
+	return sqlite::Result<ContentStore>::Fail(status);
+  }
+}
+
+template<bool HasOwnership>
+sqlite::Result<sqlite::Database::RowId, sqlite::Status> ContentStore::Store(sqlite::Database &database,
+																			sqlite::Blob<HasOwnership> &&data) const {
+  using IdResult = sqlite::Result<sqlite::Database::RowId, sqlite::Status>;
+  const auto digest = Sha256::Hash(data);
+  const Blob<false> hash(digest.data(), static_cast<Blob<false>::SizeType>(digest.size()));
+
+  // Reuse an existing chunk with identical content without writing its data again
+  sqlite::Database::RowId id = -1;
+  Status status = lookup_statement_([&](Query &query) {
+	const Status result = query.Set(0, hash).Than(query);
+	if (result.DataAvailable()) {
+	  id = query.Get<sqlite::Database::RowId>(0);
+	}
+	return result;
+  });
+  if (!status) {
+	return IdResult::Fail(status);
+  } else if (id != -1) {
+	status = acquire_statement_([&](Query &query) {
+	  return query.Set(0, id).Than(query);
+	});
+	return status ? IdResult::Ok(id) : IdResult::Fail(status);
+  }
+
+  status = insert_statement_([&](Query &query) {
+	return query.Set(0, hash)
+		.Than([&]() {
+		  if constexpr (HasOwnership) {
+			return query.Set(1, std::move(data));
+		  } else {
+			return query.SetView(1, data);
+		  }
+		}).Than(query)
+		.Than([&]() {
+		  id = database.LastInsertedRow();
+		  return Status();
+		});
+  });
+  return status ? IdResult::Ok(id) : IdResult::Fail(status);
+}
+
+template sqlite::Result<sqlite::Database::RowId, sqlite::Status> ContentStore::Store<true>(sqlite::Database &,
+																						   sqlite::Blob<true> &&) const;
+template sqlite::Result<sqlite::Database::RowId, sqlite::Status> ContentStore::Store<false>(sqlite::Database &,
+																							sqlite::Blob<false> &&) const;
+
+sqlite::Result<ContentStore::Statistics, sqlite::Status> ContentStore::Summarize() const {
+  Statistics statistics{0, 0, 0, 0};
+  const Status status = statistics_statement_([&](Query &query) {
+	return query().Than([&]() {
+	  statistics.references = query.Get<std::int_fast64_t>(0);
+	  statistics.unique_chunks = query.Get<std::int_fast64_t>(1);
+	  statistics.logical_size = query.Get<SizeType>(2);
+	  statistics.stored_size = query.Get<SizeType>(3);
+	  return Status();
+	});
+  });
+
+  if (status) {
+	return sqlite::Result<Statistics, sqlite::Status>::Ok(statistics);
+  } else {
+	return sqlite::Result<Statistics, sqlite::Status>::Fail(status);
+  }
+}
+
+}
\ No newline at end of file
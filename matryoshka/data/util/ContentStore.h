@@ -0,0 +1,70 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_MATRYOSHKA_DATA_UTIL_CONTENTSTORE_H_
+#define MATRYOSHKA_MATRYOSHKA_DATA_UTIL_CONTENTSTORE_H_
+
+#include "../sqlite/Database.h"
+#include "../sqlite/PreparedStatement.h"
+#include "../sqlite/Blob.h"
+#include "../sqlite/Result.h"
+
+#include "MetaTable.h"
+
+#include <cstdint>
+
+namespace matryoshka::data::util {
+/**
+ * The reference-counted store of chunks shared between deduplicated files. Each chunk is identified by the SHA-256
+ * of its content and written only once; removing the last reference is handled by a trigger on the data table.
+ */
+class ContentStore {
+ public:
+  using SizeType = sqlite::BlobBase::SizeType;
+
+  struct Statistics {
+	std::int_fast64_t references, unique_chunks;
+	SizeType logical_size, stored_size;
+
+	/**
+	 * The ratio between the bytes referenced by files and the bytes actually stored. Higher is better.
+	 */
+	[[nodiscard]] inline double Ratio() const noexcept {
+	  return stored_size > 0 ? static_cast<double>(logical_size) / static_cast<double>(stored_size) : 1.0;
+	}
+  };
+
+  static sqlite::Result<ContentStore> Prepare(sqlite::Database &database, const MetaTable &meta);
+  ContentStore(ContentStore &&other) noexcept = default;
+  ContentStore(ContentStore const &) = delete;
+  ContentStore &operator=(ContentStore const &) = delete;
+
+  /**
+   * Store a chunk or add a reference to an existing chunk with identical content.
+   * @param database The database the statements were prepared on.
+   * @param data The content of the chunk.
+   * @return The id of the chunk in the content table.
+   */
+  template<bool HasOwnership>
+  sqlite::Result<sqlite::Database::RowId, sqlite::Status> Store(sqlite::Database &database,
+																sqlite::Blob<HasOwnership> &&data) const;
+
+  [[nodiscard]] sqlite::Result<Statistics, sqlite::Status> Summarize() const;
+
+ protected:
+  ContentStore(sqlite::PreparedStatement &&lookup_statement,
+			   sqlite::PreparedStatement &&acquire_statement,
+			   sqlite::PreparedStatement &&insert_statement,
+			   sqlite::PreparedStatement &&statistics_statement) noexcept;
+
+ private:
+  sqlite::PreparedStatement lookup_statement_, acquire_statement_, insert_statement_, statistics_statement_;
+};
+}
+
+#endif //MATRYOSHKA_MATRYOSHKA_DATA_UTIL_CONTENTSTORE_H_
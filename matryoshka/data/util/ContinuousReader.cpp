@@ -10,7 +10,7 @@ You should have received a copy of the GNU Affero General Public License along w
 
 namespace matryoshka::data::util {
 
-ContinuousReader::ContinuousReader(int length, int start) : Reader(start), data_(length) {
+ContinuousReader::ContinuousReader(SizeType length, SizeType start) : Reader(start), data_(length) {
 
 }
 
@@ -19,12 +19,15 @@ sqlite::Blob<true> ContinuousReader::Release(ContinuousReader &&reader) {
   return std::move(reader.data_);
 }
 
-int ContinuousReader::Length() const noexcept {
+Reader::SizeType ContinuousReader::Length() const noexcept {
   return data_.Size();
 }
 
-sqlite::Status ContinuousReader::HandleBlob(sqlite::BlobReader &blob, int blob_offset, int bytes_read, int num_bytes) {
-  return blob.Read(data_, blob_offset, bytes_read, num_bytes);
+sqlite::Status ContinuousReader::HandleBlob(sqlite::BlobReader &blob,
+											int blob_offset,
+											SizeType bytes_read,
+											int num_bytes) {
+  return this->Copy(blob, data_.Data() + bytes_read, blob_offset, num_bytes);
 }
 
 }
\ No newline at end of file
@@ -16,11 +16,11 @@ class ContinuousReader : public Reader {
  public:
   static sqlite::Blob<true> Release(ContinuousReader &&reader);
 
-  explicit ContinuousReader(int length, int start = 0);
-  [[nodiscard]] int Length() const noexcept override;
+  explicit ContinuousReader(SizeType length, SizeType start = 0);
+  [[nodiscard]] SizeType Length() const noexcept override;
 
  protected:
-  sqlite::Status HandleBlob(sqlite::BlobReader &blob, int blob_offset, int bytes_read, int num_bytes) override;
+  sqlite::Status HandleBlob(sqlite::BlobReader &blob, int blob_offset, SizeType bytes_read, int num_bytes) override;
 
  private:
   sqlite::Blob<true> data_;
@@ -0,0 +1,144 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "InputFile.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <fstream>
+#include <mutex>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#endif
+
+namespace matryoshka::data::util {
+
+#ifdef _WIN32
+// Files are not mapped, but read through a stream positioned under a lock.
+struct InputFile::Handle {
+  std::ifstream stream;
+  SizeType size;
+  std::mutex mutex;
+};
+#else
+struct InputFile::Handle {
+  int descriptor;
+  SizeType size;
+  void *mapping;
+
+  ~Handle() noexcept {
+	if (mapping != nullptr) {
+	  ::munmap(mapping, static_cast<std::size_t>(size));
+	}
+	::close(descriptor);
+  }
+};
+#endif
+
+InputFile::InputFile(std::unique_ptr<Handle> &&handle) noexcept: handle_(std::move(handle)) {}
+
+InputFile::InputFile(InputFile &&other) noexcept = default;
+
+InputFile::~InputFile() noexcept = default;
+
+InputFile::SizeType InputFile::Size() const noexcept {
+  return handle_->size;
+}
+
+#ifdef _WIN32
+
+Result<InputFile> InputFile::Open(std::string_view path) noexcept {
+  auto handle = std::make_unique<Handle>();
+  handle->stream.open(std::string(path), std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
+  if (!handle->stream) {
+	return Result<InputFile>::Fail(errors::Io::FileNotFound);
+  }
+  handle->size = static_cast<SizeType>(handle->stream.tellg());
+  return Result<InputFile>(InputFile(std::move(handle)));
+}
+
+std::optional<sqlite::Blob<false>> InputFile::Mapping() const noexcept {
+  return std::nullopt;
+}
+
+std::optional<Error> InputFile::Read(SizeType offset, void *destination, SizeType length) const noexcept {
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  handle_->stream.seekg(offset);
+  handle_->stream.read(static_cast<char *>(destination), length);
+  if (handle_->stream.gcount() != length) {
+	handle_->stream.clear();
+	return Error(errors::Io::ReadingError);
+  }
+  return std::nullopt;
+}
+
+#else
+
+Result<InputFile> InputFile::Open(std::string_view path) noexcept {
+  const std::string path_string(path);
+  const int descriptor = ::open(path_string.c_str(), O_RDONLY | O_CLOEXEC);
+  if (descriptor < 0) {
+	return Result<InputFile>::Fail(errors::Io::FileNotFound);
+  }
+
+  struct stat status{};
+  if (::fstat(descriptor, &status) != 0) {
+	::close(descriptor);
+	return Result<InputFile>::Fail(errors::Io::ReadingError);
+  }
+  std::unique_ptr<Handle> handle(new Handle{descriptor, static_cast<SizeType>(status.st_size), nullptr});
+
+  // Without a mapping, i.e. for empty files or special file systems, the file is read by its offsets instead
+  if (handle->size > 0) {
+	void *mapping = ::mmap(nullptr, static_cast<std::size_t>(handle->size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+	if (mapping != MAP_FAILED) {
+	  ::madvise(mapping, static_cast<std::size_t>(handle->size), MADV_SEQUENTIAL);
+	  handle->mapping = mapping;
+	}
+  }
+  return Result<InputFile>(InputFile(std::move(handle)));
+}
+
+std::optional<sqlite::Blob<false>> InputFile::Mapping() const noexcept {
+  if (handle_->mapping == nullptr) {
+	return std::nullopt;
+  }
+  return sqlite::Blob<false>(static_cast<const unsigned char *>(handle_->mapping), handle_->size);
+}
+
+std::optional<Error> InputFile::Read(SizeType offset, void *destination, SizeType length) const noexcept {
+  if (offset < 0 || length < 0 || offset + length > handle_->size) {
+	return Error(errors::Io::OutOfBounds);
+  } else if (handle_->mapping != nullptr) {
+	std::memcpy(destination, static_cast<const unsigned char *>(handle_->mapping) + offset, length);
+	return std::nullopt;
+  }
+
+  auto *bytes = static_cast<char *>(destination);
+  while (length > 0) {
+	const ssize_t num_read = ::pread(handle_->descriptor, bytes, static_cast<std::size_t>(length), offset);
+	if (num_read < 0 && errno == EINTR) {
+	  continue;
+	} else if (num_read <= 0) {
+	  return Error(errors::Io::ReadingError);
+	}
+	bytes += num_read;
+	offset += num_read;
+	length -= num_read;
+  }
+  return std::nullopt;
+}
+
+#endif
+
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_MATRYOSHKA_DATA_UTIL_INPUTFILE_H_
+#define MATRYOSHKA_MATRYOSHKA_DATA_UTIL_INPUTFILE_H_
+
+#include "../sqlite/Blob.h"
+#include "../Error.h"
+
+#include <optional>
+#include <string_view>
+#include <memory>
+
+namespace matryoshka::data::util {
+/**
+ * A local file read by its offsets. If possible, it is mapped into memory, so its content is available without copying
+ * it into a buffer first.
+ */
+class InputFile {
+ public:
+  using SizeType = sqlite::BlobBase::SizeType;
+
+  /**
+   * Open a local file for reading and try to map it into memory.
+   * @param path The path of the local file.
+   * @return The opened file.
+   */
+  static Result<InputFile> Open(std::string_view path) noexcept;
+  InputFile(InputFile &&other) noexcept;
+  ~InputFile() noexcept;
+  InputFile(InputFile const &) = delete;
+  InputFile &operator=(InputFile const &) = delete;
+
+  [[nodiscard]] SizeType Size() const noexcept;
+
+  /**
+   * Access the mapping of the whole file. It is valid as long as the file is opened.
+   * @return The content of the file, if it is mapped into memory.
+   */
+  [[nodiscard]] std::optional<sqlite::Blob<false>> Mapping() const noexcept;
+
+  /**
+   * Copy a part of the file, either from its mapping or by reading at the offset.
+   * @param offset The offset in the file.
+   * @param destination The memory written to. It needs to hold at least length bytes.
+   * @param length The number of bytes read.
+   * @return An error, if the part could not be read completely.
+   */
+  std::optional<Error> Read(SizeType offset, void *destination, SizeType length) const noexcept;
+
+ protected:
+  struct Handle;
+  explicit InputFile(std::unique_ptr<Handle> &&handle) noexcept;
+
+ private:
+  std::unique_ptr<Handle> handle_;
+};
+}
+
+#endif //MATRYOSHKA_MATRYOSHKA_DATA_UTIL_INPUTFILE_H_
@@ -14,6 +14,7 @@ You should have received a copy of the GNU Affero General Public License along w
 #include <limits>
 #include <charconv>
 #include <algorithm>
+#include <utility>
 
 namespace matryoshka::data::util {
 
@@ -90,23 +91,37 @@ std::string_view MetaTable::Data() const noexcept {
   return "Matryoshka_Data";
 }
 
+std::string_view MetaTable::Content() const noexcept {
+  return "Matryoshka_Content";
+}
+
 std::string MetaTable::Format(std::string_view input) const {
+  const std::pair<std::string_view, std::string_view> replacements[] = {
+	  {MetaTable::FORMAT_META, this->Meta()},
+	  {MetaTable::FORMAT_DATA, this->Data()},
+	  {MetaTable::FORMAT_CONTENT, this->Content()}
+  };
+
   std::string result;
   result.reserve(input.size() + this->Meta().size() + this->Data().size());
 
   std::string_view::size_type last_index = 0;
   while (last_index < input.size()) {
-	auto index_meta = input.find(MetaTable::FORMAT_META, last_index),
-		index_data = input.find(MetaTable::FORMAT_DATA, last_index);
-
-	if (index_meta < index_data && index_meta != std::string_view::npos) {
-	  result.append(input, last_index, index_meta - last_index);
-	  result.append(this->Meta());
-	  last_index = index_meta + MetaTable::FORMAT_META.size();
-	} else if (index_data < index_meta && index_data != std::string_view::npos) {
-	  result.append(input, last_index, index_data - last_index);
-	  result.append(this->Data());
-	  last_index = index_data + MetaTable::FORMAT_DATA.size();
+	// Find the next placeholder of any kind
+	auto next_index = std::string_view::npos;
+	const std::pair<std::string_view, std::string_view> *next_replacement = nullptr;
+	for (const auto &replacement: replacements) {
+	  const auto index = input.find(replacement.first, last_index);
+	  if (index < next_index) {
+		next_index = index;
+		next_replacement = &replacement;
+	  }
+	}
+
+	if (next_replacement != nullptr) {
+	  result.append(input, last_index, next_index - last_index);
+	  result.append(next_replacement->second);
+	  last_index = next_index + next_replacement->first.size();
 	} else {
 	  result.append(input, last_index);
 	  last_index = std::string_view::npos;
@@ -116,4 +131,11 @@ std::string MetaTable::Format(std::string_view input) const {
   return result;
 }
 
+sqlite::Status MetaTable::Rename(sqlite::Database &database, const MetaTable &target) const {
+  // SQLite updates the references of the data table on its own.
+  std::string command("ALTER TABLE ");
+  command.append(this->Meta()).append(" RENAME TO ").append(target.Meta());
+  return database(command);
+}
+
 }
\ No newline at end of file
@@ -18,6 +18,7 @@ class MetaTable {
  public:
   static constexpr std::string_view FORMAT_META = "{meta}";
   static constexpr std::string_view FORMAT_DATA = "{data}";
+  static constexpr std::string_view FORMAT_CONTENT = "{content}";
   using Version = unsigned int;
 
   explicit MetaTable(Version version) noexcept;
@@ -26,7 +27,9 @@ class MetaTable {
   [[nodiscard]] Version Id() const noexcept;
   [[nodiscard]] std::string_view Meta() const noexcept;
   [[nodiscard]] std::string_view Data() const noexcept;
+  [[nodiscard]] std::string_view Content() const noexcept;
   [[nodiscard]] std::string Format(std::string_view input) const;
+  sqlite::Status Rename(sqlite::Database &database, const MetaTable &target) const;
 
   bool operator==(const MetaTable &rhs) const noexcept;
   bool operator!=(const MetaTable &rhs) const noexcept;
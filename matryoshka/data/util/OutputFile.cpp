@@ -0,0 +1,188 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "OutputFile.h"
+
+#ifdef _WIN32
+#include <fstream>
+#include <filesystem>
+#include <mutex>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <cerrno>
+#endif
+
+namespace matryoshka::data::util {
+
+#ifdef _WIN32
+// Without positional writes at hand, a single stream is shared and positioned under a lock.
+struct OutputFile::Handle {
+  std::string path;
+  std::fstream stream;
+  std::mutex mutex;
+};
+#else
+struct OutputFile::Handle {
+  int descriptor;
+  // The range allocated on disk by the last reservation, which may be mapped safely
+  SizeType allocated_begin, allocated_end;
+
+  ~Handle() noexcept {
+	::close(descriptor);
+  }
+};
+#endif
+
+OutputFile::OutputFile(std::unique_ptr<Handle> &&handle) noexcept: handle_(std::move(handle)) {}
+
+OutputFile::OutputFile(OutputFile &&other) noexcept = default;
+
+OutputFile::~OutputFile() noexcept = default;
+
+OutputFile::Mapping::Mapping(void *region, std::size_t region_size, unsigned char *data, SizeType size) noexcept
+	: region_(region), region_size_(region_size), data_(data), size_(size) {}
+
+OutputFile::Mapping::Mapping(Mapping &&other) noexcept
+	: region_(other.region_), region_size_(other.region_size_), data_(other.data_), size_(other.size_) {
+  other.region_ = nullptr;
+}
+
+#ifdef _WIN32
+
+Result<OutputFile> OutputFile::Open(std::string_view path, bool truncate) noexcept {
+  auto handle = std::make_unique<Handle>();
+  handle->path = std::string(path);
+  if (truncate || !std::filesystem::exists(handle->path)) {
+	std::ofstream(handle->path, std::ofstream::binary | std::ofstream::trunc).close();
+  }
+  handle->stream.open(handle->path, std::fstream::in | std::fstream::out | std::fstream::binary);
+  if (!handle->stream) {
+	return Result<OutputFile>::Fail(errors::Io::FileCreationFailed);
+  }
+  return Result<OutputFile>(OutputFile(std::move(handle)));
+}
+
+OutputFile::SizeType OutputFile::Size() const noexcept {
+  std::error_code code;
+  const auto size = std::filesystem::file_size(handle_->path, code);
+  return code ? SizeType(-1) : static_cast<SizeType>(size);
+}
+
+std::optional<Error> OutputFile::Reserve(SizeType size) noexcept {
+  std::error_code code;
+  if (this->Size() < size) {
+	std::lock_guard<std::mutex> lock(handle_->mutex);
+	handle_->stream.flush();
+	std::filesystem::resize_file(handle_->path, size, code);
+  }
+  return code ? std::optional<Error>(errors::Io::WritingError) : std::nullopt;
+}
+
+std::optional<Error> OutputFile::Write(SizeType offset, const void *data, SizeType length) noexcept {
+  std::lock_guard<std::mutex> lock(handle_->mutex);
+  handle_->stream.seekp(offset);
+  handle_->stream.write(static_cast<const char *>(data), length);
+  handle_->stream.flush();
+  return handle_->stream ? std::nullopt : std::optional<Error>(errors::Io::WritingError);
+}
+
+OutputFile::Mapping::~Mapping() noexcept = default;
+
+std::optional<OutputFile::Mapping> OutputFile::Map(SizeType offset, SizeType length) noexcept {
+  return std::nullopt;
+}
+
+#else
+
+Result<OutputFile> OutputFile::Open(std::string_view path, bool truncate) noexcept {
+  const std::string path_string(path);
+  // Mapping requires read access, but files only writable are still written by their offsets
+  const int flags = O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+  int descriptor = ::open(path_string.c_str(), O_RDWR | flags, 0644);
+  if (descriptor < 0 && errno == EACCES) {
+	descriptor = ::open(path_string.c_str(), O_WRONLY | flags, 0644);
+  }
+  if (descriptor < 0) {
+	return Result<OutputFile>::Fail(errors::Io::FileCreationFailed);
+  }
+  return Result<OutputFile>(OutputFile(std::unique_ptr<Handle>(new Handle{descriptor, 0, 0})));
+}
+
+OutputFile::SizeType OutputFile::Size() const noexcept {
+  struct stat status{};
+  return ::fstat(handle_->descriptor, &status) == 0 ? static_cast<SizeType>(status.st_size) : SizeType(-1);
+}
+
+std::optional<Error> OutputFile::Reserve(SizeType size) noexcept {
+  handle_->allocated_begin = handle_->allocated_end = 0;
+  const SizeType current_size = this->Size();
+  if (current_size < 0) {
+	return Error(errors::Io::WritingError);
+  } else if (current_size >= size) {
+	return std::nullopt;
+  }
+
+#ifdef __linux__
+  // Some file systems cannot allocate ahead, but the file still needs its final size
+  const int result = ::posix_fallocate(handle_->descriptor, current_size, size - current_size);
+  if (result == 0) {
+	handle_->allocated_begin = current_size;
+	handle_->allocated_end = size;
+	return std::nullopt;
+  } else if (result != EINVAL && result != EOPNOTSUPP) {
+	return Error(errors::Io::WritingError);
+  }
+#endif
+  return ::ftruncate(handle_->descriptor, size) == 0 ? std::nullopt : std::optional<Error>(errors::Io::WritingError);
+}
+
+std::optional<Error> OutputFile::Write(SizeType offset, const void *data, SizeType length) noexcept {
+  const auto *bytes = static_cast<const char *>(data);
+  while (length > 0) {
+	const ssize_t written = ::pwrite(handle_->descriptor, bytes, static_cast<std::size_t>(length), offset);
+	if (written < 0) {
+	  if (errno == EINTR) {
+		continue;
+	  }
+	  return Error(errors::Io::WritingError);
+	}
+	bytes += written;
+	offset += written;
+	length -= written;
+  }
+  return std::nullopt;
+}
+
+OutputFile::Mapping::~Mapping() noexcept {
+  if (region_ != nullptr) {
+	::munmap(region_, region_size_);
+  }
+}
+
+std::optional<OutputFile::Mapping> OutputFile::Map(SizeType offset, SizeType length) noexcept {
+  if (length <= 0 || offset < handle_->allocated_begin || offset + length > handle_->allocated_end) {
+	return std::nullopt;
+  }
+
+  // The mapping has to start at a page boundary
+  const auto page_size = static_cast<SizeType>(::sysconf(_SC_PAGESIZE));
+  const SizeType region_offset = page_size > 0 ? offset - offset % page_size : offset;
+  const auto region_size = static_cast<std::size_t>(offset - region_offset + length);
+  void *region = ::mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, handle_->descriptor, region_offset);
+  if (region == MAP_FAILED) {
+	return std::nullopt;
+  }
+  return Mapping(region, region_size, static_cast<unsigned char *>(region) + (offset - region_offset), length);
+}
+
+#endif
+
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_MATRYOSHKA_DATA_UTIL_OUTPUTFILE_H_
+#define MATRYOSHKA_MATRYOSHKA_DATA_UTIL_OUTPUTFILE_H_
+
+#include "../sqlite/Blob.h"
+#include "../Error.h"
+
+#include <optional>
+#include <string_view>
+#include <memory>
+#include <cstddef>
+
+namespace matryoshka::data::util {
+/**
+ * A local file written at explicit offsets. There is no shared position, so several threads may write disjoint ranges
+ * concurrently.
+ */
+class OutputFile {
+ public:
+  using SizeType = sqlite::BlobBase::SizeType;
+
+  /**
+   * A writable region of the file in memory. The content is written back by the operating system once it is released.
+   */
+  class Mapping {
+   public:
+	Mapping(Mapping &&other) noexcept;
+	~Mapping() noexcept;
+	Mapping(Mapping const &) = delete;
+	Mapping &operator=(Mapping const &) = delete;
+
+	[[nodiscard]] inline unsigned char *Data() const noexcept {
+	  return data_;
+	}
+
+	[[nodiscard]] inline SizeType Size() const noexcept {
+	  return size_;
+	}
+
+   private:
+	friend class OutputFile;
+	Mapping(void *region, std::size_t region_size, unsigned char *data, SizeType size) noexcept;
+
+	void *region_;
+	std::size_t region_size_;
+	unsigned char *data_;
+	SizeType size_;
+  };
+
+  /**
+   * Open a local file for writing, creating it if it does not exist.
+   * @param path The path of the local file, whose parent directory must exist.
+   * @param truncate Discard the current content of the file.
+   * @return The opened file.
+   */
+  static Result<OutputFile> Open(std::string_view path, bool truncate) noexcept;
+  OutputFile(OutputFile &&other) noexcept;
+  ~OutputFile() noexcept;
+  OutputFile(OutputFile const &) = delete;
+  OutputFile &operator=(OutputFile const &) = delete;
+
+  /**
+   * Query the current size of the file.
+   * @return The size in bytes, or a negative value on failure.
+   */
+  [[nodiscard]] SizeType Size() const noexcept;
+
+  /**
+   * Allocate the space of the file on disk ahead of writing it, so the blocks are neither fragmented by concurrent
+   * writers nor missing halfway through. The file is extended, if it is smaller.
+   * @param size The final size of the file.
+   * @return An error, if the space could not be allocated.
+   */
+  std::optional<Error> Reserve(SizeType size) noexcept;
+
+  /**
+   * Write data at an offset, independent of all other writes.
+   * @param offset The offset in the file.
+   * @param data The data written.
+   * @param length The number of bytes written.
+   * @return An error, if the data could not be written completely.
+   */
+  std::optional<Error> Write(SizeType offset, const void *data, SizeType length) noexcept;
+
+  /**
+   * Map a part of the file into memory, so it can be filled without any intermediate buffer. Only space allocated on
+   * disk by the last call of Reserve is mapped, as a write failing within a mapping could not be reported.
+   * @param offset The offset in the file.
+   * @param length The number of bytes mapped.
+   * @return The mapping, if the part is allocated and the platform supports it.
+   */
+  std::optional<Mapping> Map(SizeType offset, SizeType length) noexcept;
+
+ protected:
+  struct Handle;
+  explicit OutputFile(std::unique_ptr<Handle> &&handle) noexcept;
+
+ private:
+  std::unique_ptr<Handle> handle_;
+};
+}
+
+#endif //MATRYOSHKA_MATRYOSHKA_DATA_UTIL_OUTPUTFILE_H_
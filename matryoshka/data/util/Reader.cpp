@@ -7,17 +7,23 @@ You should have received a copy of the GNU Affero General Public License along w
 */
 
 #include "Reader.h"
+#include "Codec.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 
 namespace matryoshka::data::util {
 
-Reader::Reader(int start)
+Reader::Reader(SizeType start)
 	: current_blob_(std::nullopt),
 	  bytes_read_(0),
 	  start_offset_(start),
-	  blob_index_(0) {
+	  blob_index_(0),
+	  flags_(0),
+	  is_decoded_(false),
+	  data_offset_(0),
+	  decoded_() {
 
 }
 
@@ -30,15 +36,22 @@ std::optional<Error> Reader::operator()() {
   auto blob = std::move(current_blob_.value());
   current_blob_.reset();
 
-  int num_bytes = std::min(blob.Size(), this->Length() - bytes_read_);
-  sqlite::Status status;
+  // Compressed chunks are decoded as a whole, but only those touched by the read
+  SizeType chunk_size = blob.Size();
+  sqlite::Status status = this->Decode(blob, chunk_size);
+  if (!status) {
+	return data::Error(status);
+  }
+
+  // A single blob never exceeds the range of an int, so neither does the number of bytes read from it
+  int num_bytes = static_cast<int>(std::min<SizeType>(chunk_size, this->Length() - bytes_read_));
   if (blob_index_ == 0) {
-	num_bytes = std::min(blob.Size() - start_offset_, num_bytes);
-	if (num_bytes == 0) {
+	num_bytes = static_cast<int>(std::min<SizeType>(chunk_size - start_offset_, num_bytes));
+	if (num_bytes <= 0) {
 	  // Handle the out-of-bound case, when the chunks are not all completely filled
 	  return data::Error(errors::Io::OutOfBounds);
 	}
-	status = this->HandleBlob(blob, start_offset_, 0, num_bytes);
+	status = this->HandleBlob(blob, static_cast<int>(start_offset_), 0, num_bytes);
   } else {
 	status = this->HandleBlob(blob, 0, bytes_read_, num_bytes);
   }
@@ -57,6 +70,37 @@ std::optional<Error> Reader::operator()() {
   return std::nullopt;
 }
 
+sqlite::Status Reader::Decode(const sqlite::BlobReader &blob, SizeType &chunk_size) {
+  is_decoded_ = false;
+  data_offset_ = 0;
+  if (Codec::FromFlags(flags_) == Codec::Type::Store) {
+	return sqlite::Status();
+  }
+
+  // Chunks which did not shrink are read directly, right after their header
+  bool is_stored = false;
+  sqlite::Status status = Codec::IsStored(blob, is_stored);
+  if (status && is_stored) {
+	data_offset_ = 1;
+	chunk_size = blob.Size() - 1;
+  } else if (status && (status = Codec::Decode(blob, decoded_))) {
+	is_decoded_ = true;
+	chunk_size = decoded_.Size();
+  }
+  return status;
+}
+
+sqlite::Status Reader::Copy(const sqlite::BlobReader &blob,
+							unsigned char *destination,
+							int offset,
+							int num_bytes) const {
+  if (is_decoded_) {
+	std::memcpy(destination, decoded_.Data() + offset, num_bytes);
+	return sqlite::Status();
+  }
+  return blob.Read(destination, offset + data_offset_, num_bytes);
+}
+
 sqlite::Status Reader::Add(sqlite::Query &query) {
   bool set_offset = false;
   while (true) {
@@ -65,11 +109,10 @@ sqlite::Status Reader::Add(sqlite::Query &query) {
 	  return result;
 	}
 
-	this->Add(query.Get<int>(0));
+	this->Add(query.Get<sqlite::Database::RowId>(0));
 	if (!set_offset) {
-	  const int chunk_num = query.Get<int>(1);
-	  const int chunk_size = query.Get<int>(2);
-	  start_offset_ -= chunk_num * chunk_size;
+	  flags_ = query.Get<int>(1);
+	  start_offset_ -= query.Get<SizeType>(2);
 	  assert(start_offset_ >= 0);
 	  set_offset = true;
 	}
@@ -78,10 +121,18 @@ sqlite::Status Reader::Add(sqlite::Query &query) {
 
 sqlite::Result<sqlite::PreparedStatement> Reader::PrepareStatement(sqlite::Database &database,
 																   MetaTable &meta) {
+  // Fixed-size chunks are found by their number, content-defined ones by a range lookup on their offset.
+  // The row and number of each chunk are only required for modifying it.
   static constexpr std::string_view SQL_GET_CHUNKS = R"(
-	SELECT chunk_id, chunk_num, {meta}.chunk_size FROM {data}
+	SELECT COALESCE(content_id, chunk_id), {meta}.flags, COALESCE(chunk_offset, chunk_num * {meta}.chunk_size), chunk_id, chunk_num FROM {data}
 	INNER JOIN {meta} ON {meta}.id={data}.file_id
-	WHERE file_id = :handle AND chunk_num BETWEEN cast((:index / {meta}.chunk_size) as int) AND cast(((:index + :size - 1) / {meta}.chunk_size) as int)
+	WHERE file_id = :handle AND chunk_num BETWEEN
+	  CASE WHEN {meta}.flags & 2
+		THEN (SELECT chunk_num FROM {data} WHERE file_id = :handle AND chunk_offset <= :index ORDER BY chunk_offset DESC LIMIT 1)
+		ELSE cast((:index / {meta}.chunk_size) as int) END
+	  AND CASE WHEN {meta}.flags & 2
+		THEN (SELECT chunk_num FROM {data} WHERE file_id = :handle AND chunk_offset <= :index + :size - 1 ORDER BY chunk_offset DESC LIMIT 1)
+		ELSE cast(((:index + :size - 1) / {meta}.chunk_size) as int) END
 	ORDER BY chunk_num ASC
   )";
   return sqlite::PreparedStatement::Create(database, meta.Format(SQL_GET_CHUNKS));
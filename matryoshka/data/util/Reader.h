@@ -24,11 +24,13 @@ You should have received a copy of the GNU Affero General Public License along w
 namespace matryoshka::data::util {
 class Reader {
  public:
-  [[nodiscard]] virtual int Length() const noexcept = 0;
+  using SizeType = sqlite::BlobBase::SizeType;
+
+  [[nodiscard]] virtual SizeType Length() const noexcept = 0;
 
   static sqlite::Result<sqlite::PreparedStatement> PrepareStatement(sqlite::Database &database, MetaTable &meta);
 
-  explicit Reader(int start = 0);
+  explicit Reader(SizeType start = 0);
   std::optional<Error> operator()();
 
   sqlite::Status Add(sqlite::Query &query);
@@ -37,7 +39,7 @@ class Reader {
   }
 
   explicit inline operator bool() const noexcept {
-	const int length = this->Length();
+	const SizeType length = this->Length();
 	return length == bytes_read_ && length > 0;
   }
 
@@ -45,11 +47,15 @@ class Reader {
 	return !blob_indices_.empty() ? blob_indices_[0] : -1;
   }
 
-  [[nodiscard]] inline int StartOffset() const {
+  [[nodiscard]] inline int Flags() const noexcept {
+	return flags_;
+  }
+
+  [[nodiscard]] inline SizeType StartOffset() const {
 	return start_offset_;
   }
 
-  inline void SetStartOffset(int start_offset) {
+  inline void SetStartOffset(SizeType start_offset) {
 	if (start_offset >= 0 && bytes_read_ == 0) {
 	  start_offset_ = start_offset;
 	}
@@ -60,11 +66,28 @@ class Reader {
   }
 
  protected:
-  virtual sqlite::Status HandleBlob(sqlite::BlobReader &blob, int blob_offset, int bytes_read, int num_bytes) = 0;
+  virtual sqlite::Status HandleBlob(sqlite::BlobReader &blob, int blob_offset, SizeType bytes_read, int num_bytes) = 0;
+
+  /**
+   * Copy the content of the current chunk, which is decompressed transparently.
+   * @param blob The blob of the chunk.
+   * @param destination The memory written to.
+   * @param offset The offset in the content of the chunk.
+   * @param num_bytes The number of bytes to copy.
+   * @return The status of reading.
+   */
+  sqlite::Status Copy(const sqlite::BlobReader &blob, unsigned char *destination, int offset, int num_bytes) const;
 
  private:
+  sqlite::Status Decode(const sqlite::BlobReader &blob, SizeType &chunk_size);
+
   std::optional<sqlite::BlobReader> current_blob_;
-  int bytes_read_, start_offset_, blob_index_;
+  SizeType bytes_read_, start_offset_;
+  std::size_t blob_index_;
+  int flags_;
+  bool is_decoded_;
+  int data_offset_;
+  sqlite::Blob<true> decoded_;
   std::vector<sqlite::Database::RowId> blob_indices_;
 };
 }
@@ -0,0 +1,142 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace matryoshka::data::util {
+
+namespace {
+constexpr std::uint32_t ROUND_CONSTANTS[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline std::uint32_t RotateRight(std::uint32_t value, int bits) noexcept {
+  return (value >> bits) | (value << (32 - bits));
+}
+}
+
+Sha256::Sha256() noexcept
+	: state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+	  buffer_{},
+	  length_(0),
+	  buffer_size_(0) {
+
+}
+
+void Sha256::Update(const unsigned char *data, std::size_t length) noexcept {
+  length_ += length;
+
+  // Complete a partially filled block first
+  if (buffer_size_ > 0) {
+	const std::size_t num_bytes = std::min(length, sizeof(buffer_) - buffer_size_);
+	std::memcpy(buffer_ + buffer_size_, data, num_bytes);
+	buffer_size_ += num_bytes;
+	data += num_bytes;
+	length -= num_bytes;
+	if (buffer_size_ < sizeof(buffer_)) {
+	  return;
+	}
+	this->Transform(buffer_);
+	buffer_size_ = 0;
+  }
+
+  // Hash full blocks directly from the input
+  for (; length >= sizeof(buffer_); data += sizeof(buffer_), length -= sizeof(buffer_)) {
+	this->Transform(data);
+  }
+
+  if (length > 0) {
+	std::memcpy(buffer_, data, length);
+	buffer_size_ = length;
+  }
+}
+
+Sha256::Digest Sha256::Finish() noexcept {
+  // Pad with a single bit, zeros and the message length in bits
+  const std::uint64_t num_bits = length_ * 8;
+  unsigned char padding[72] = {0x80};
+  const std::size_t padding_size = (buffer_size_ < 56 ? 56 : 120) - buffer_size_;
+  for (int i = 0; i < 8; ++i) {
+	padding[padding_size + i] = static_cast<unsigned char>(num_bits >> (56 - 8 * i));
+  }
+  this->Update(padding, padding_size + 8);
+
+  Digest digest;
+  for (std::size_t i = 0; i < 8; ++i) {
+	digest[i * 4] = static_cast<unsigned char>(state_[i] >> 24);
+	digest[i * 4 + 1] = static_cast<unsigned char>(state_[i] >> 16);
+	digest[i * 4 + 2] = static_cast<unsigned char>(state_[i] >> 8);
+	digest[i * 4 + 3] = static_cast<unsigned char>(state_[i]);
+  }
+  return digest;
+}
+
+std::string Sha256::ToHex(const Digest &digest) {
+  static constexpr char HEX[] = "0123456789abcdef";
+  std::string result;
+  result.reserve(digest.size() * 2);
+  for (auto byte: digest) {
+	result.push_back(HEX[byte >> 4]);
+	result.push_back(HEX[byte & 0x0f]);
+  }
+  return result;
+}
+
+void Sha256::Transform(const unsigned char *block) noexcept {
+  std::uint32_t w[64];
+  for (int i = 0; i < 16; ++i) {
+	w[i] = (static_cast<std::uint32_t>(block[i * 4]) << 24) | (static_cast<std::uint32_t>(block[i * 4 + 1]) << 16)
+		| (static_cast<std::uint32_t>(block[i * 4 + 2]) << 8) | static_cast<std::uint32_t>(block[i * 4 + 3]);
+  }
+  for (int i = 16; i < 64; ++i) {
+	const std::uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+	const std::uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+	w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  std::uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3], e = state_[4], f = state_[5],
+	  g = state_[6], h = state_[7];
+  for (int i = 0; i < 64; ++i) {
+	const std::uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+	const std::uint32_t choice = (e & f) ^ (~e & g);
+	const std::uint32_t temp1 = h + s1 + choice + ROUND_CONSTANTS[i] + w[i];
+	const std::uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+	const std::uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+	const std::uint32_t temp2 = s0 + majority;
+
+	h = g;
+	g = f;
+	f = e;
+	e = d + temp1;
+	d = c;
+	c = b;
+	b = a;
+	a = temp1 + temp2;
+  }
+
+  state_[0] += a;
+  state_[1] += b;
+  state_[2] += c;
+  state_[3] += d;
+  state_[4] += e;
+  state_[5] += f;
+  state_[6] += g;
+  state_[7] += h;
+}
+
+}
\ No newline at end of file
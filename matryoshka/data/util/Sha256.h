@@ -0,0 +1,50 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_MATRYOSHKA_DATA_UTIL_SHA256_H_
+#define MATRYOSHKA_MATRYOSHKA_DATA_UTIL_SHA256_H_
+
+#include "../sqlite/Blob.h"
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace matryoshka::data::util {
+/**
+ * An incremental implementation of SHA-256, used for identifying chunks by their content.
+ */
+class Sha256 {
+ public:
+  using Digest = std::array<unsigned char, 32>;
+
+  Sha256() noexcept;
+
+  void Update(const unsigned char *data, std::size_t length) noexcept;
+  [[nodiscard]] Digest Finish() noexcept;
+
+  inline static Digest Hash(const sqlite::BlobBase &data) noexcept {
+	Sha256 hash;
+	hash.Update(data.Data(), data.size());
+	return hash.Finish();
+  }
+
+  static std::string ToHex(const Digest &digest);
+
+ private:
+  void Transform(const unsigned char *block) noexcept;
+
+  std::uint32_t state_[8];
+  unsigned char buffer_[64];
+  std::uint64_t length_;
+  std::size_t buffer_size_;
+};
+}
+
+#endif //MATRYOSHKA_MATRYOSHKA_DATA_UTIL_SHA256_H_
@@ -4,11 +4,111 @@
 
 #include "Server.h"
 
+#include <cctype>
+
 using namespace matryoshka::data;
 
 namespace matryoshka::server {
 
-Server::Server(data::FileSystem &&file_system) : file_system_(std::move(file_system)) {
+/**
+ * The body of a response streamed asynchronously. The next part is only read once the previous one was written to
+ * the client, so a slow client neither blocks a worker nor makes the whole file buffered in memory.
+ */
+class Server::Transfer : public std::enable_shared_from_this<Server::Transfer> {
+ public:
+  using Response = restinio::response_builder_t<restinio::user_controlled_output_t>;
+
+  Transfer(FileSystemPool *file_systems,
+		   restinio::asio_ns::io_context *io_context,
+		   File &&file,
+		   Response &&response,
+		   std::vector<ByteRange> &&ranges,
+		   std::vector<std::string> &&part_headers)
+	  : file_systems_(file_systems),
+		io_context_(io_context),
+		file_(std::move(file)),
+		response_(std::move(response)),
+		ranges_(std::move(ranges)),
+		part_headers_(std::move(part_headers)),
+		range_(0),
+		position_(0) {}
+
+  /**
+   * Read and send the next part of the body. The connection to the container is only leased while reading, so no
+   * statement is kept open while waiting for the client. If all connections are busy, the part is read later instead
+   * of blocking the thread, which serves the other clients meanwhile.
+   */
+  void Continue() {
+	SizeType budget = Server::MAXIMAL_IN_FLIGHT;
+	std::optional<Error> error;
+	{
+	  auto file_system = file_systems_->TryAcquire();
+	  if (!file_system) {
+		restinio::asio_ns::post(*io_context_, [self = this->shared_from_this()]() { self->Continue(); });
+		return;
+	  }
+	  while (!error && budget > 0 && range_ < ranges_.size()) {
+		const ByteRange &range = ranges_[range_];
+		if (position_ == 0 && !part_headers_.empty()) {
+		  response_.append_body(part_headers_[range_]);
+		}
+
+		// Touch only the chunks covering the part of the range
+		const SizeType length = std::min(budget, range.length - position_);
+		if (length > 0) {
+		  error = (*file_system)->Read(file_, range.start + position_, length, [&](FileSystem::Chunk &&blob) {
+			response_.append_body(std::forward<FileSystem::Chunk>(blob));
+			return true;
+		  });
+		}
+		budget -= length;
+		position_ += length;
+		if (position_ == range.length) {
+		  ++range_;
+		  position_ = 0;
+		}
+	  }
+	}
+
+	// The header is already sent, so a failure is only signaled by closing the connection
+	if (error) {
+	  response_.connection_close();
+	  response_.done();
+	  return;
+	} else if (range_ == ranges_.size()) {
+	  if (!part_headers_.empty()) {
+		response_.append_body(part_headers_.back());
+	  }
+	  response_.done();
+	  return;
+	}
+
+	response_.flush([self = this->shared_from_this()](const restinio::asio_ns::error_code &write_error) {
+	  if (!write_error) {
+		self->Continue();
+	  }
+	});
+  }
+
+ private:
+  FileSystemPool *file_systems_;
+  restinio::asio_ns::io_context *io_context_;
+  File file_;
+  Response response_;
+  std::vector<ByteRange> ranges_;
+  std::vector<std::string> part_headers_;
+  std::size_t range_;
+  SizeType position_;
+};
+
+Server::Server(std::unique_ptr<data::FileSystemPool> &&file_systems,
+			   FileSystem &&writer,
+			   int chunk_size,
+			   restinio::asio_ns::io_context &io_context)
+	: file_systems_(std::move(file_systems)),
+	  writer_(std::move(writer)),
+	  chunk_size_(chunk_size),
+	  io_context_(&io_context) {
 
 }
 
@@ -16,41 +116,136 @@ restinio::request_handling_status_t Server::operator()(restinio::request_handle_
   const restinio::http_method_id_t method = req->header().method();
   if (method == restinio::http_method_get() || method == restinio::http_method_head()) {
 	return this->handle_query(std::move(req));
+  } else if (method == restinio::http_method_put()) {
+	return this->handle_upload(std::move(req));
+  } else if (method == restinio::http_method_propfind()) {
+	return this->handle_listing(std::move(req));
+  } else if (method == restinio::http_method_move() || method == restinio::http_method_copy()) {
+	return this->handle_transfer(std::move(req), method == restinio::http_method_copy());
   }
 
-  // TODO: OPTIONS, PROPFIND, MKCOL, DELETE, MOVE, PUT
+  // TODO: OPTIONS, MKCOL, DELETE
   return req->create_response(restinio::status_not_implemented()).done();
 }
 
 restinio::request_handling_status_t Server::handle_query(restinio::request_handle_t req) {
-  // Parse the path and try to open the file
-  const Path path(req->header().request_target());
-  auto file_container = file_system_.Open(path);
+  // Parse the path and try to open the file. The connection is returned before the body is streamed.
+  std::optional<FileSystemPool::Lease> lease(file_systems_->Acquire());
+  FileSystem &file_system = **lease;
+  const Path path(Server::DecodePath(req->header().request_target()));
+  auto file_container = file_system.Open(path);
 
   File *file;
   if ((file = std::get_if<File>(&file_container)) != nullptr) {
-	// Query the file size
-	const int file_size = file_system_.Size(*file);
+	// Query the metadata stored in the header of the file, which requires no chunk to be read
+	auto metadata_container = file_system.Stat(*file);
+	if (!metadata_container) {
+	  return req->create_response(restinio::status_internal_server_error())
+		  .append_header(restinio::http_field::server, "Matryoshka")
+		  .append_header_date_field()
+		  .done();
+	}
+	const FileSystem::Metadata &metadata = std::get<FileSystem::Metadata>(metadata_container);
+	const auto file_size = metadata.size;
 	const bool header_only = req->header().method() == restinio::http_method_head();
 
+	// Validators allowing clients to reuse their copy
+	const std::string entity_tag = Server::EntityTag(metadata);
+	std::string last_modified;
+	if (metadata.modified.has_value()) {
+	  last_modified = Server::FormatDate(metadata.modified.value());
+	}
+	auto append_validators = [&](auto &response) {
+	  if (!entity_tag.empty()) {
+		response.append_header(restinio::http_field::etag, entity_tag);
+	  }
+	  if (!last_modified.empty()) {
+		response.append_header(restinio::http_field::last_modified, last_modified);
+	  }
+	};
+
+	// Answer conditional requests of clients with the current representation without reading any data
+	bool is_unmodified = false;
+	if (req->header().has_field(restinio::http_field::if_none_match)) {
+	  is_unmodified = !entity_tag.empty()
+		  && Server::MatchesEntityTag(req->header().get_field(restinio::http_field::if_none_match), entity_tag);
+	} else if (req->header().has_field(restinio::http_field::if_modified_since) && metadata.modified.has_value()) {
+	  const auto since = Server::ParseDate(req->header().get_field(restinio::http_field::if_modified_since));
+	  is_unmodified = since.has_value() && metadata.modified.value() / 1000 <= since.value();
+	}
+	if (is_unmodified) {
+	  auto response = req->create_response(restinio::status_not_modified());
+	  response.append_header(restinio::http_field::server, "Matryoshka")
+		  .append_header_date_field();
+	  append_validators(response);
+	  return response.done();
+	}
+
+	// Answer only the requested ranges, if the header is well-formed
+	std::vector<ByteRange> ranges{ByteRange{0, file_size}};
+	bool is_partial = false;
+	if (req->header().has_field(restinio::http_field::range)) {
+	  auto requested_ranges = Server::ParseRanges(req->header().get_field(restinio::http_field::range), file_size);
+	  if (requested_ranges.has_value() && requested_ranges->empty()) {
+		return req->create_response(restinio::http_status_line_t(restinio::http_status_code_t(416),
+																 "Range Not Satisfiable"))
+			.append_header(restinio::http_field::server, "Matryoshka")
+			.append_header_date_field()
+			.append_header(restinio::http_field::content_range, "bytes */" + std::to_string(file_size))
+			.done();
+	  } else if (requested_ranges.has_value()) {
+		ranges = std::move(requested_ranges.value());
+		is_partial = true;
+	  }
+	}
+
 	// Prepare the response
-	auto response = req->create_response<restinio::user_controlled_output_t>(restinio::status_ok());
+	auto response = req->create_response<restinio::user_controlled_output_t>(
+		is_partial ? restinio::http_status_line_t(restinio::http_status_code_t(206), "Partial Content")
+				   : restinio::status_ok());
 	response.append_header(restinio::http_field::server, "Matryoshka")
 		.append_header_date_field()
-		.set_content_length(file_size);
+		.append_header(restinio::http_field::accept_ranges, "bytes");
+	append_validators(response);
 
-	// Send the data in GET, but not HEAD request
-	if (!header_only) {
-	  response.flush(); // Send header
-	  // Write the data chunkwise
-	  file_system_.Read(*file, 0, file_size, [&](FileSystem::Chunk &&blob) {
-		response.append_body(std::forward<FileSystem::Chunk>(blob));
-		response.flush();
-		return true;
-	  });
+	// Multiple ranges are sent as parts of a multipart body, each with its own header
+	constexpr std::string_view BOUNDARY = "MATRYOSHKA_BYTERANGES";
+	auto content_range = [file_size](const ByteRange &range) {
+	  return "bytes " + std::to_string(range.start) + "-" + std::to_string(range.start + range.length - 1) + "/"
+		  + std::to_string(file_size);
+	};
+	std::vector<std::string> part_headers;
+	SizeType content_length = 0;
+	if (ranges.size() > 1) {
+	  for (const auto &range: ranges) {
+		part_headers.emplace_back(std::string("\r\n--").append(BOUNDARY).append("\r\nContent-Range: ")
+									  .append(content_range(range)).append("\r\n\r\n"));
+		content_length += static_cast<SizeType>(part_headers.back().size()) + range.length;
+	  }
+	  part_headers.emplace_back(std::string("\r\n--").append(BOUNDARY).append("--\r\n"));
+	  content_length += static_cast<SizeType>(part_headers.back().size());
+	  response.append_header(restinio::http_field::content_type,
+							 std::string("multipart/byteranges; boundary=").append(BOUNDARY));
+	} else {
+	  content_length = ranges.front().length;
+	  if (is_partial) {
+		response.append_header(restinio::http_field::content_range, content_range(ranges.front()));
+	  }
 	}
+	response.set_content_length(content_length);
 
-	return response.done();
+	// Send the data in GET, but not HEAD request
+	if (header_only) {
+	  return response.done();
+	}
+	lease.reset();
+	std::make_shared<Transfer>(file_systems_.get(),
+							   io_context_,
+							   File(file->Handle()),
+							   std::move(response),
+							   std::move(ranges),
+							   std::move(part_headers))->Continue();
+	return restinio::request_accepted();
   } else {
 	return req->create_response(restinio::status_not_found())
 		.append_header(restinio::http_field::server, "Matryoshka")
@@ -59,4 +254,425 @@ restinio::request_handling_status_t Server::handle_query(restinio::request_handl
   }
 }
 
+restinio::request_handling_status_t Server::handle_upload(restinio::request_handle_t req) {
+  auto respond = [&req](restinio::http_status_line_t status) {
+	return req->create_response(std::move(status))
+		.append_header(restinio::http_field::server, "Matryoshka")
+		.append_header_date_field()
+		.done();
+  };
+
+  // Restinio hands over the complete body, already reassembled if it was sent chunked. It is passed on in small
+  // pieces, so only the chunk currently written is copied.
+  const Path path(Server::DecodePath(req->header().request_target()));
+  const std::string &body = req->body();
+  const auto body_size = static_cast<SizeType>(body.size());
+  auto source = [&body, body_size, offset = SizeType(0)](int size) mutable {
+	const SizeType length = std::min<SizeType>(std::min(size, UPLOAD_PIECE_SIZE), body_size - offset);
+	FileSystem::Chunk piece(sqlite::Blob<false>(reinterpret_cast<const unsigned char *>(body.data()) + offset, length));
+	offset += length;
+	return piece;
+  };
+
+  // An existing file is replaced, but kept unless the new one is written completely
+  bool is_replaced = false, is_created = false;
+  {
+	std::lock_guard<std::mutex> lock(writer_mutex_);
+
+	// Folders are not replaced by files (RFC 4918, 9.7.2), and no file may become a folder to hold the new one
+	if (!path || writer_.OpenFolder(path)) {
+	  return respond(restinio::status_method_not_allowed());
+	}
+	const std::string target = path.AbsolutePath();
+	for (std::size_t end = target.find('/'); end != std::string::npos; end = target.find('/', end + 1)) {
+	  if (writer_.Open(Path(std::string_view(target).substr(0, end)))) {
+		return respond(restinio::status_conflict());
+	  }
+	}
+
+	auto transaction = writer_.Begin();
+	if (transaction) {
+	  auto existing = writer_.Open(path);
+	  if (!existing || (is_replaced = writer_.Delete(std::move(std::get<File>(existing))))) {
+		is_created = writer_.Create(path, source, body_size, chunk_size_)
+			&& std::get<sqlite::Transaction>(transaction).Commit();
+	  }
+	}
+  }
+
+  if (!is_created) {
+	return respond(restinio::status_internal_server_error());
+  }
+  return respond(is_replaced ? restinio::status_no_content() : restinio::status_created());
+}
+
+restinio::request_handling_status_t Server::handle_listing(restinio::request_handle_t req) {
+  // Recursive listings are unbounded and refused (RFC 4918, 9.1). All properties are reported regardless of the body.
+  const std::string depth = req->header().get_field_or("Depth", "infinity");
+  if (depth != "0" && depth != "1") {
+	return req->create_response(restinio::status_forbidden())
+		.append_header(restinio::http_field::server, "Matryoshka")
+		.append_header_date_field()
+		.done();
+  }
+
+  const Path path(Server::DecodePath(req->header().request_target()));
+  const std::string href = "/" + Server::EscapePath(path.AbsolutePath());
+  std::string body = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<D:multistatus xmlns:D=\"DAV:\">\n";
+  bool is_found = true, is_failed = false;
+  {
+	auto file_system = file_systems_->Acquire();
+	auto file_container = file_system->Open(path);
+	if (auto *file = std::get_if<File>(&file_container); file != nullptr) {
+	  auto metadata = file_system->Stat(*file);
+	  is_failed = !metadata;
+	  if (!is_failed) {
+		Server::AppendProperties(body, href, false, std::get<FileSystem::Metadata>(metadata));
+	  }
+	} else {
+	  // All entries of a folder are read from the index on their parent at once
+	  auto entries_container = file_system->List(path);
+	  const auto *entries = std::get_if<std::vector<FileSystem::Entry>>(&entries_container);
+	  is_found = entries != nullptr;
+	  is_failed = !is_found && std::get<Error>(entries_container) != Error(errors::Io::FileNotFound);
+	  if (is_found) {
+		const std::string folder_href = path ? href + "/" : href;
+		Server::AppendProperties(body, folder_href, true, FileSystem::Metadata{0, std::nullopt, std::nullopt});
+		for (std::size_t i = 0; depth == "1" && i < entries->size(); ++i) {
+		  const FileSystem::Entry &entry = (*entries)[i];
+		  Server::AppendProperties(body,
+								   folder_href + Server::EscapePath(entry.name) + (entry.is_folder ? "/" : ""),
+								   entry.is_folder,
+								   entry.metadata);
+		}
+	  }
+	}
+  }
+  body.append("</D:multistatus>\n");
+
+  if (is_failed || !is_found) {
+	return req->create_response(is_failed ? restinio::status_internal_server_error() : restinio::status_not_found())
+		.append_header(restinio::http_field::server, "Matryoshka")
+		.append_header_date_field()
+		.done();
+  }
+  return req->create_response(restinio::http_status_line_t(restinio::http_status_code_t(207), "Multi-Status"))
+	  .append_header(restinio::http_field::server, "Matryoshka")
+	  .append_header_date_field()
+	  .append_header(restinio::http_field::content_type, "application/xml; charset=utf-8")
+	  .set_body(std::move(body))
+	  .done();
+}
+
+restinio::request_handling_status_t Server::handle_transfer(restinio::request_handle_t req, bool is_copy) {
+  auto respond = [&req](restinio::http_status_line_t status) {
+	return req->create_response(std::move(status))
+		.append_header(restinio::http_field::server, "Matryoshka")
+		.append_header_date_field()
+		.done();
+  };
+  if (!req->header().has_field("Destination")) {
+	return respond(restinio::status_bad_request());
+  }
+
+  // Neither the source nor the destination may contain the other, as one of them would be replaced (RFC 4918, 9.9.4)
+  const Path source(Server::DecodePath(req->header().request_target()));
+  const Path destination(Server::DecodePath(req->header().get_field("Destination")));
+  const std::string source_path = source.AbsolutePath(), destination_path = destination.AbsolutePath();
+  if (!source || !destination || source_path == destination_path
+	  || source_path.rfind(destination_path + '/', 0) == 0 || destination_path.rfind(source_path + '/', 0) == 0) {
+	return respond(restinio::status_forbidden());
+  }
+
+  // An existing destination is replaced, unless the client forbids it
+  const bool may_overwrite = req->header().get_field_or("Overwrite", "T") != "F";
+  bool is_replaced = false;
+  std::optional<Error> error;
+  {
+	std::lock_guard<std::mutex> lock(writer_mutex_);
+	if (!writer_.Open(source) && !writer_.OpenFolder(source)) {
+	  return respond(restinio::status_not_found());
+	}
+	auto file = writer_.Open(destination);
+	auto folder = writer_.OpenFolder(destination);
+	is_replaced = file || folder;
+	if (is_replaced && !may_overwrite) {
+	  return respond(restinio::status_precondition_failed());
+	}
+
+	// The destination is only deleted together with a successful transfer
+	auto transaction = writer_.Begin();
+	if (!transaction) {
+	  error = std::get<Error>(std::move(transaction));
+	} else {
+	  bool is_deleted = true;
+	  if (file) {
+		is_deleted = writer_.Delete(std::move(std::get<File>(file)));
+	  } else if (folder) {
+		is_deleted = writer_.Delete(std::move(std::get<Folder>(folder)));
+	  }
+
+	  error = !is_deleted ? Error(errors::Io::WritingError)
+						  : is_copy ? writer_.Copy(source, destination) : writer_.Move(source, destination);
+	  if (!error.has_value()) {
+		const sqlite::Status status = std::get<sqlite::Transaction>(transaction).Commit();
+		if (!status) {
+		  error = Error(status);
+		}
+	  }
+	}
+  }
+
+  if (!error.has_value()) {
+	return respond(is_replaced ? restinio::status_no_content() : restinio::status_created());
+  } else if (error.value() == Error(errors::Io::FileNotFound)) {
+	return respond(restinio::status_not_found());
+  } else if (error.value() == Error(errors::Io::FileExists)) {
+	return respond(restinio::status_precondition_failed());
+  }
+  return respond(restinio::status_internal_server_error());
+}
+
+std::string Server::DecodePath(std::string_view target) {
+  // Absolute URLs, as in the "Destination" header, are reduced to their path
+  if (const std::size_t scheme = target.find("://"); scheme != std::string_view::npos) {
+	const std::size_t path = target.find('/', scheme + 3);
+	target = path == std::string_view::npos ? std::string_view("/") : target.substr(path);
+  }
+  target = target.substr(0, target.find_first_of("?#"));
+
+  auto hex_value = [](char digit) {
+	return std::isdigit(static_cast<unsigned char>(digit)) ? digit - '0' : std::tolower(digit) - 'a' + 10;
+  };
+  std::string decoded;
+  decoded.reserve(target.size());
+  for (std::size_t i = 0; i < target.size(); ++i) {
+	if (target[i] == '%' && i + 2 < target.size() && std::isxdigit(static_cast<unsigned char>(target[i + 1]))
+		&& std::isxdigit(static_cast<unsigned char>(target[i + 2]))) {
+	  decoded.push_back(static_cast<char>(hex_value(target[i + 1]) * 16 + hex_value(target[i + 2])));
+	  i += 2;
+	} else {
+	  decoded.push_back(target[i]);
+	}
+  }
+  return decoded;
+}
+
+std::string Server::EntityTag(const FileSystem::Metadata &metadata) {
+  // Files modified in place have no hash anymore and are identified by their size and time of modification
+  if (metadata.hash.has_value()) {
+	return "\"" + metadata.hash.value() + "\"";
+  } else if (metadata.modified.has_value()) {
+	return "W/\"" + std::to_string(metadata.size) + "-" + std::to_string(metadata.modified.value()) + "\"";
+  }
+  return std::string();
+}
+
+std::string Server::EscapePath(std::string_view path) {
+  // Everything but the unreserved characters and the separator is percent-encoded, so no XML escaping is needed
+  static constexpr char HEX[] = "0123456789ABCDEF";
+  std::string escaped;
+  escaped.reserve(path.size());
+  for (const char character: path) {
+	const auto byte = static_cast<unsigned char>(character);
+	if (std::isalnum(byte) || character == '-' || character == '.' || character == '_' || character == '~'
+		|| character == '/') {
+	  escaped.push_back(character);
+	} else {
+	  escaped.push_back('%');
+	  escaped.push_back(HEX[byte >> 4u]);
+	  escaped.push_back(HEX[byte & 0x0fu]);
+	}
+  }
+  return escaped;
+}
+
+void Server::AppendProperties(std::string &body,
+							  std::string_view href,
+							  bool is_folder,
+							  const FileSystem::Metadata &metadata) {
+  body.append("<D:response><D:href>").append(href).append("</D:href><D:propstat><D:prop>");
+  if (is_folder) {
+	body.append("<D:resourcetype><D:collection/></D:resourcetype>");
+  } else {
+	body.append("<D:resourcetype/><D:getcontentlength>").append(std::to_string(metadata.size))
+		.append("</D:getcontentlength>");
+	const std::string entity_tag = Server::EntityTag(metadata);
+	if (!entity_tag.empty()) {
+	  body.append("<D:getetag>").append(entity_tag).append("</D:getetag>");
+	}
+  }
+  if (metadata.modified.has_value()) {
+	body.append("<D:getlastmodified>").append(Server::FormatDate(metadata.modified.value()))
+		.append("</D:getlastmodified>");
+  }
+  body.append("</D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>\n");
+}
+
+std::optional<std::vector<Server::ByteRange>> Server::ParseRanges(std::string_view header, SizeType file_size) {
+  constexpr std::string_view UNIT = "bytes=";
+  if (header.substr(0, UNIT.size()) != UNIT) {
+	return std::nullopt;
+  }
+  header.remove_prefix(UNIT.size());
+
+  // Parse a non-negative number, which must not be empty
+  auto parse_number = [](std::string_view text, SizeType &number) {
+	if (text.empty() || text.size() > 18) {
+	  return false;
+	}
+	number = 0;
+	for (char digit: text) {
+	  if (digit < '0' || digit > '9') {
+		return false;
+	  }
+	  number = number * 10 + (digit - '0');
+	}
+	return true;
+  };
+
+  std::vector<ByteRange> ranges;
+  std::size_t num_ranges = 0;
+  while (!header.empty()) {
+	// Split the next range from the list and strip the whitespace
+	const std::size_t separator = header.find(',');
+	std::string_view range = header.substr(0, separator);
+	header.remove_prefix(separator == std::string_view::npos ? header.size() : separator + 1);
+	range.remove_prefix(std::min(range.find_first_not_of(" \t"), range.size()));
+	range.remove_suffix(range.size() - std::min(range.find_last_not_of(" \t") + 1, range.size()));
+	if (range.empty()) {
+	  continue;
+	} else if (++num_ranges > MAXIMAL_RANGES) {
+	  return std::nullopt;
+	}
+
+	const std::size_t dash = range.find('-');
+	if (dash == std::string_view::npos) {
+	  return std::nullopt;
+	}
+	SizeType first = 0, last = 0;
+	if (dash == 0) {
+	  // The suffix of the file
+	  if (!parse_number(range.substr(1), last)) {
+		return std::nullopt;
+	  } else if (last > 0 && file_size > 0) {
+		const SizeType length = std::min(last, file_size);
+		ranges.push_back(ByteRange{file_size - length, length});
+	  }
+	} else {
+	  if (!parse_number(range.substr(0, dash), first)) {
+		return std::nullopt;
+	  } else if (dash + 1 == range.size()) {
+		last = file_size - 1;
+	  } else if (!parse_number(range.substr(dash + 1), last) || last < first) {
+		return std::nullopt;
+	  }
+	  if (first < file_size) {
+		ranges.push_back(ByteRange{first, std::min(last, file_size - 1) - first + 1});
+	  }
+	}
+  }
+
+  // A header without any range is malformed
+  if (num_ranges == 0) {
+	return std::nullopt;
+  }
+  return ranges;
+}
+
+namespace {
+constexpr std::string_view WEEKDAYS[] = {"Thu", "Fri", "Sat", "Sun", "Mon", "Tue", "Wed"};
+constexpr std::string_view MONTHS[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+// The number of days since the epoch of a date in the proleptic Gregorian calendar.
+std::int_fast64_t DaysFromCivil(std::int_fast64_t year, unsigned int month, unsigned int day) {
+  year -= month <= 2;
+  const std::int_fast64_t era = (year >= 0 ? year : year - 399) / 400;
+  const auto year_of_era = static_cast<unsigned int>(year - era * 400);
+  const unsigned int day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const unsigned int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + static_cast<std::int_fast64_t>(day_of_era) - 719468;
+}
+
+// The inverse of DaysFromCivil.
+void CivilFromDays(std::int_fast64_t days, std::int_fast64_t &year, unsigned int &month, unsigned int &day) {
+  days += 719468;
+  const std::int_fast64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  const auto day_of_era = static_cast<unsigned int>(days - era * 146097);
+  const unsigned int year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+  const unsigned int day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  const unsigned int shifted_month = (5 * day_of_year + 2) / 153;
+  day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+  month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+  year = static_cast<std::int_fast64_t>(year_of_era) + era * 400 + (month <= 2);
+}
+}
+
+std::string Server::FormatDate(std::int_fast64_t milliseconds) {
+  const std::int_fast64_t seconds = (milliseconds >= 0 ? milliseconds : milliseconds - 999) / 1000;
+  const std::int_fast64_t days = (seconds >= 0 ? seconds : seconds - 86399) / 86400;
+  const std::int_fast64_t time = seconds - days * 86400;
+
+  std::int_fast64_t year = 0;
+  unsigned int month = 0, day = 0;
+  CivilFromDays(days, year, month, day);
+
+  auto two_digits = [](std::int_fast64_t number) {
+	return std::string(1, static_cast<char>('0' + number / 10)) + static_cast<char>('0' + number % 10);
+  };
+  return std::string(WEEKDAYS[((days % 7) + 7) % 7]).append(", ").append(two_digits(day)).append(" ")
+	  .append(MONTHS[month - 1]).append(" ").append(std::to_string(year)).append(" ")
+	  .append(two_digits(time / 3600)).append(":").append(two_digits(time / 60 % 60)).append(":")
+	  .append(two_digits(time % 60)).append(" GMT");
+}
+
+std::optional<std::int_fast64_t> Server::ParseDate(std::string_view date) {
+  // "Sun, 06 Nov 1994 08:49:37 GMT"
+  if (date.size() != 29 || date.substr(3, 2) != ", " || date.substr(25) != " GMT" || date[7] != ' '
+	  || date[11] != ' ' || date[16] != ' ' || date[19] != ':' || date[22] != ':') {
+	return std::nullopt;
+  }
+
+  auto parse_number = [&](std::size_t offset, std::size_t length, unsigned int &number) {
+	number = 0;
+	for (char digit: date.substr(offset, length)) {
+	  if (digit < '0' || digit > '9') {
+		return false;
+	  }
+	  number = number * 10 + (digit - '0');
+	}
+	return true;
+  };
+  unsigned int day = 0, month = 0, year = 0, hours = 0, minutes = 0, seconds = 0;
+  while (month < 12 && MONTHS[month] != date.substr(8, 3)) {
+	++month;
+  }
+  if (month == 12 || !parse_number(5, 2, day) || !parse_number(12, 4, year) || !parse_number(17, 2, hours)
+	  || !parse_number(20, 2, minutes) || !parse_number(23, 2, seconds) || day < 1 || day > 31 || hours > 23
+	  || minutes > 59 || seconds > 60) {
+	return std::nullopt;
+  }
+  return DaysFromCivil(year, month + 1, day) * 86400 + hours * 3600 + minutes * 60 + seconds;
+}
+
+bool Server::MatchesEntityTag(std::string_view header, std::string_view entity_tag) {
+  // The weak comparison ignores the weakness indicator of both tags
+  auto opaque_tag = [](std::string_view tag) {
+	return tag.substr(0, 2) == "W/" ? tag.substr(2) : tag;
+  };
+  const std::string_view current = opaque_tag(entity_tag);
+
+  while (!header.empty()) {
+	const std::size_t separator = header.find(',');
+	std::string_view tag = header.substr(0, separator);
+	header.remove_prefix(separator == std::string_view::npos ? header.size() : separator + 1);
+	tag.remove_prefix(std::min(tag.find_first_not_of(" \t"), tag.size()));
+	tag.remove_suffix(tag.size() - std::min(tag.find_last_not_of(" \t") + 1, tag.size()));
+	if (tag == "*" || (!tag.empty() && opaque_tag(tag) == current)) {
+	  return true;
+	}
+  }
+  return false;
+}
+
 }
\ No newline at end of file
@@ -6,20 +6,127 @@
 #define MATRYOSHKA_MATRYOSHKA_SERVER_SERVER_H_
 
 #include "../data/FileSystem.h"
+#include "../data/FileSystemPool.h"
 
 #include <restinio/all.hpp>
 
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <string>
+#include <string_view>
+
 namespace matryoshka::server {
+/**
+ * The handler of the requests, which may be called from several threads at once. Each reading request leases its own
+ * connection to the container, while the modifying requests share a single writer one after the other.
+ */
 class Server {
  public:
-  explicit Server(matryoshka::data::FileSystem &&file_system);
+  using SizeType = matryoshka::data::FileSystem::SizeType;
+
+  // A satisfiable part of a file requested by the "Range" header.
+  struct ByteRange {
+	SizeType start, length;
+  };
+
+  // Requests with more ranges are answered with the whole file.
+  constexpr static std::size_t MAXIMAL_RANGES = 64;
+
+  // The bytes of a body read ahead of the client at most, which bounds the memory used per connection.
+  constexpr static SizeType MAXIMAL_IN_FLIGHT = 256 * 1024;
+
+  // The size of the pieces an uploaded body is handed to the file system in.
+  constexpr static int UPLOAD_PIECE_SIZE = 64 * 1024;
+
+  /**
+   * Create the handler.
+   * @param file_systems The read-only connections serving the reading requests.
+   * @param writer The connection used for modifications.
+   * @param chunk_size The chunk size of uploaded files.
+   * @param io_context The context running the server, on which postponed responses are continued.
+   */
+  Server(std::unique_ptr<matryoshka::data::FileSystemPool> &&file_systems,
+		 matryoshka::data::FileSystem &&writer,
+		 int chunk_size,
+		 restinio::asio_ns::io_context &io_context);
   restinio::request_handling_status_t operator()(restinio::request_handle_t req);
 
+  /**
+   * Parse the value of a "Range" header according to RFC 7233.
+   * @param header The value of the header.
+   * @param file_size The size of the requested file.
+   * @return The satisfiable ranges, which are empty if none is. Nothing, if the header is malformed and ignored.
+   */
+  static std::optional<std::vector<ByteRange>> ParseRanges(std::string_view header, SizeType file_size);
+
+  /**
+   * Format a point in time as HTTP-date according to RFC 7231, i.e. "Sun, 06 Nov 1994 08:49:37 GMT".
+   * @param milliseconds The milliseconds since the epoch.
+   * @return The formatted date with a precision of seconds.
+   */
+  static std::string FormatDate(std::int_fast64_t milliseconds);
+
+  /**
+   * Parse a HTTP-date in its preferred, fixed-length format.
+   * @param date The value of a header like "If-Modified-Since".
+   * @return The seconds since the epoch. Nothing, if the date is malformed and ignored.
+   */
+  static std::optional<std::int_fast64_t> ParseDate(std::string_view date);
+
+  /**
+   * Check whether an entity tag is listed in an "If-None-Match" header, using the weak comparison.
+   * @param header The value of the header, i.e. "*" or a comma-separated list of entity tags.
+   * @param entity_tag The current entity tag of the file.
+   * @return True, if the client already has the current representation.
+   */
+  static bool MatchesEntityTag(std::string_view header, std::string_view entity_tag);
+
+  /**
+   * Derive the entity tag of a file from its metadata.
+   * @param metadata The metadata of the file.
+   * @return The strong tag of the content hash, a weak tag of the size and modification time or nothing if neither is
+   * known.
+   */
+  static std::string EntityTag(const matryoshka::data::FileSystem::Metadata &metadata);
+
+  /**
+   * Percent-encode a path for use in an URL, keeping its separators.
+   * @param path The unescaped path.
+   * @return The escaped path, which is safe to be placed in XML as well.
+   */
+  static std::string EscapePath(std::string_view path);
+
+  /**
+   * Extract the path from a request target or an absolute URL and decode its percent-encoded characters.
+   * @param target The request target or URL, which may contain a query.
+   * @return The decoded path.
+   */
+  static std::string DecodePath(std::string_view target);
+
  protected:
   restinio::request_handling_status_t handle_query(restinio::request_handle_t req);
+  restinio::request_handling_status_t handle_upload(restinio::request_handle_t req);
+  restinio::request_handling_status_t handle_listing(restinio::request_handle_t req);
+  restinio::request_handling_status_t handle_transfer(restinio::request_handle_t req, bool is_copy);
+
+  /**
+   * Append the properties of a file or folder as "response" element of a WebDAV multi-status body.
+   */
+  static void AppendProperties(std::string &body,
+							   std::string_view href,
+							   bool is_folder,
+							   const matryoshka::data::FileSystem::Metadata &metadata);
 
  private:
-  matryoshka::data::FileSystem file_system_;
+  class Transfer;
+
+  std::unique_ptr<matryoshka::data::FileSystemPool> file_systems_;
+  matryoshka::data::FileSystem writer_;
+  std::mutex writer_mutex_;
+  int chunk_size_;
+  restinio::asio_ns::io_context *io_context_;
 };
 }
 
@@ -5,13 +5,30 @@
 #include <restinio/all.hpp>
 #include <CLI/CLI.hpp>
 
+#include <thread>
+#include <algorithm>
+#include <limits>
+
 #include "Server.h"
 
 using namespace matryoshka::data;
 using namespace matryoshka::server;
 
-FileSystem Open(std::string_view path) {
-  auto database = sqlite::Database::Create(path);
+Server Open(std::string_view path,
+			std::string_view profile,
+			std::size_t num_threads,
+			int chunk_size,
+			restinio::asio_ns::io_context &io_context) {
+  auto options = sqlite::Database::Options::Preset(profile);
+  if (!options.has_value()) {
+	throw CLI::RuntimeError("Unknown database profile", 1);
+  }
+
+  // The readers would block the writer and each other with a rollback journal, so the server always uses WAL
+  options->journal = sqlite::Database::Options::Journal::Wal;
+
+  // Open the container for writing first, so it is set up and upgraded if required
+  auto database = sqlite::Database::Create(path, options.value());
   if (!database) {
 	throw CLI::RuntimeError("Unable to open the SQLite database", 1);
   }
@@ -21,22 +38,45 @@ FileSystem Open(std::string_view path) {
 	throw CLI::RuntimeError("Unable to open the file system", 2);
   }
 
-  return std::move(std::get<FileSystem>(file_system));
+  // Each worker thread gets a read-only connection of its own
+  auto file_systems = FileSystemPool::Open(path, num_threads, options.value());
+  if (!file_systems) {
+	throw CLI::RuntimeError("Unable to open the file system", 2);
+  }
+  return Server(std::move(std::get<std::unique_ptr<FileSystemPool>>(file_systems)),
+				std::move(std::get<FileSystem>(file_system)),
+				chunk_size,
+				io_context);
 }
 
 int main(int argc, char **argv) {
-  std::string container_file;
+  std::string container_file, profile = "default", address = "localhost";
+  std::uint16_t port = 8080;
+  std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+  int chunk_size = 8192;
 
   CLI::App app("Matryoshka - WebDav");
   app.add_option("container_file", container_file, "The Matryoshka file")->check(CLI::ExistingFile)->required();
+  app.add_option("--profile",
+				 profile,
+				 "The database tuning: default, bulk-import, read-mostly or durable. WAL is always used.")
+	  ->check(CLI::IsMember({"default", "bulk-import", "read-mostly", "durable"}));
+  app.add_option("-a,--address", address, "The address the server listens on.");
+  app.add_option("-p,--port", port, "The port the server listens on.");
+  app.add_option("-t,--threads", num_threads, "The number of worker threads, each with its own connection.")
+	  ->check(CLI::Range(1, 1024));
+  app.add_option("--chunk-size", chunk_size, "The chunk size of uploaded files.")
+	  ->check(CLI::Range(1, std::numeric_limits<int>::max()));
 
   try {
 	(app).parse((argc), (argv));
-	Server server(Open(container_file));
+	restinio::asio_ns::io_context io_context;
+	Server server = Open(container_file, profile, num_threads, chunk_size, io_context);
 	restinio::run(
-		restinio::on_this_thread()
-			.port(8080)
-			.address("localhost")
+		io_context,
+		restinio::on_thread_pool(num_threads)
+			.port(port)
+			.address(address)
 			.request_handler([&server](auto req) { return server(req); }));
   } catch (const CLI::ParseError &e) {
 	return (app).exit(e);
@@ -9,6 +9,7 @@ You should have received a copy of the GNU Affero General Public License along w
 #include "Api.h"
 
 #include "../data/FileSystem.h"
+#include "../data/Importer.h"
 
 struct FileSystem {
   matryoshka::data::FileSystem file_system_;
@@ -64,7 +65,16 @@ inline R *HandleError(Status **status, matryoshka::data::Result<T> &&value) {
 }
 
 FileSystem *Load(const char *path, Status **status) {
-  auto database = matryoshka::data::sqlite::Database::Create(path);
+  return LoadWithProfile(path, nullptr, status);
+}
+
+FileSystem *LoadWithProfile(const char *path, const char *profile, Status **status) {
+  const auto options = matryoshka::data::sqlite::Database::Options::Preset(profile != nullptr ? profile : "default");
+  if (path == nullptr || !options.has_value()) {
+	return HandleError<FileSystem>(status, matryoshka::data::errors::ArgumentError());
+  }
+
+  auto database = matryoshka::data::sqlite::Database::Create(path, options.value());
   if (!database) {
 	return HandleError<FileSystem>(status, std::move(database));
   }
@@ -119,6 +129,52 @@ FileHandle *Push(FileSystem *file_system,
   return new FileHandle(std::move(std::get<matryoshka::data::File>(result)));
 }
 
+Status *PushBatch(FileSystem *file_system,
+				  const char *const *inner_paths,
+				  const char *const *file_paths,
+				  int num_files,
+				  int chunk_size,
+				  int batch_size,
+				  int num_readers,
+				  int *num_pushed) {
+  if (num_pushed != nullptr) {
+	*num_pushed = 0;
+  }
+  if (file_system == nullptr || inner_paths == nullptr || file_paths == nullptr || num_files < 0 || batch_size <= 0
+	  || num_readers <= 0) {
+	return new Status(matryoshka::data::Error(matryoshka::data::errors::ArgumentError()));
+  }
+
+  std::vector<matryoshka::data::Importer::Job> jobs;
+  jobs.reserve(num_files);
+  for (int i = 0; i < num_files; ++i) {
+	if (inner_paths[i] == nullptr || file_paths[i] == nullptr) {
+	  return new Status(matryoshka::data::Error(matryoshka::data::errors::ArgumentError()));
+	}
+	jobs.push_back(matryoshka::data::Importer::Job{matryoshka::data::Path(inner_paths[i]), file_paths[i]});
+  }
+
+  // The first file skipped is reported, while the others are still pushed
+  std::optional<matryoshka::data::Error> first_error;
+  matryoshka::data::Importer importer(&file_system->file_system_,
+									  matryoshka::data::Importer::Options{
+										  static_cast<std::size_t>(num_readers),
+										  matryoshka::data::Importer::DEFAULT_BUFFER_SIZE, batch_size, chunk_size});
+  auto summary = importer.Import(jobs,
+								 [&](const matryoshka::data::Importer::Job &, const matryoshka::data::Error &error) {
+								   if (!first_error.has_value()) {
+									 first_error = error;
+								   }
+								 });
+  if (!summary) {
+	return new Status(std::get<matryoshka::data::Error>(summary));
+  }
+  if (num_pushed != nullptr) {
+	*num_pushed = summary->num_imported;
+  }
+  return first_error.has_value() ? new Status(first_error.value()) : nullptr;
+}
+
 Status *Pull(FileSystem *file_system, FileHandle *file, const char *file_path) {
   if (file_system == nullptr || file == nullptr || file_path == nullptr || !static_cast<bool>(file->file_)) {
 	return new Status(matryoshka::data::Error(matryoshka::data::errors::ArgumentError()));
@@ -129,6 +185,16 @@ Status *Pull(FileSystem *file_system, FileHandle *file, const char *file_path) {
   return result ? new Status(result.value()) : nullptr;
 }
 
+Status *ReadInto(FileSystem *file_system, FileHandle *file, int64_t offset, void *buffer, int64_t size) {
+  if (file_system == nullptr || file == nullptr || !static_cast<bool>(file->file_) || offset < 0 || size < 0
+	  || (buffer == nullptr && size > 0)) {
+	return new Status(matryoshka::data::Error(matryoshka::data::errors::ArgumentError()));
+  }
+
+  auto result = file_system->file_system_.Read(file->file_, offset, buffer, size);
+  return result ? new Status(result.value()) : nullptr;
+}
+
 int Find(FileSystem *file_system, const char *path, void (*callback)(const char *)) {
   if (file_system == nullptr) {
 	return 0;
@@ -149,7 +215,7 @@ int Find(FileSystem *file_system, const char *path, void (*callback)(const char
   return paths.size();
 }
 
-int GetSize(FileSystem *file_system, FileHandle *file) {
+int64_t GetSize(FileSystem *file_system, FileHandle *file) {
   if (file == nullptr || file_system == nullptr || !static_cast<bool>(file->file_)) {
 	return 0;
   }
@@ -162,3 +228,21 @@ int Delete(FileSystem *file_system, FileHandle *file) {
 		 ) ? 0 : 1;
 }
 
+Status *Move(FileSystem *file_system, const char *from, const char *to) {
+  if (file_system == nullptr || from == nullptr || to == nullptr) {
+	return new Status(matryoshka::data::Error(matryoshka::data::errors::ArgumentError()));
+  }
+
+  auto result = file_system->file_system_.Move(matryoshka::data::Path(from), matryoshka::data::Path(to));
+  return result ? new Status(result.value()) : nullptr;
+}
+
+Status *Copy(FileSystem *file_system, const char *from, const char *to) {
+  if (file_system == nullptr || from == nullptr || to == nullptr) {
+	return new Status(matryoshka::data::Error(matryoshka::data::errors::ArgumentError()));
+  }
+
+  auto result = file_system->file_system_.Copy(matryoshka::data::Path(from), matryoshka::data::Path(to));
+  return result ? new Status(result.value()) : nullptr;
+}
+
@@ -11,6 +11,8 @@ You should have received a copy of the GNU Affero General Public License along w
 
 #include <matryoshka_export.h>
 
+#include <cstdint>
+
 extern "C" {
 struct FileSystem;
 struct Status;
@@ -24,6 +26,15 @@ struct FileHandle;
  */
 MATRYOSHKA_EXPORT FileSystem *Load(const char *path, Status **status);
 
+/**
+ * Open a SQlite database containing the Matryoshka virtual file system with a database tuning.
+ * @param path The path to the Matryoshka SQlite database.
+ * @param profile The database tuning, i.e. "default", "bulk-import", "read-mostly" or "durable". Passing nullptr is equal to "default".
+ * @param status Contains the error code of the failure if and only if the return value is nullptr. Setting this value to nullptr is safe and will not save the error code.
+ * @return A pointer to the virtual file system or nullptr on failure.
+ */
+MATRYOSHKA_EXPORT FileSystem *LoadWithProfile(const char *path, const char *profile, Status **status);
+
 /**
  * Destroy a file system.
  * @param file_system The virtual file system. Passing nullptr is a safe no-op.
@@ -73,6 +84,28 @@ MATRYOSHKA_EXPORT FileHandle *Push(FileSystem *file_system,
 								   int chunk_size,
 								   Status **status);
 
+/**
+ * Push many files to the virtual file system. The files are read by several threads and committed together in
+ * batches. Files failing are skipped.
+ * @param file_system A pointer to the virtual file system.
+ * @param inner_paths The inner paths on the virtual file system, one for each file.
+ * @param file_paths The paths on the real file system, one for each file.
+ * @param num_files The number of files.
+ * @param chunk_size The proposed chunk size. Negative values will let the virtual file system choose.
+ * @param batch_size The number of files committed together.
+ * @param num_readers The number of threads reading the files ahead of writing them.
+ * @param num_pushed Contains the number of files pushed successfully. Setting this value to nullptr is safe.
+ * @return The first error ocurring during operation or nullptr if every file was pushed.
+ */
+MATRYOSHKA_EXPORT Status *PushBatch(FileSystem *file_system,
+									const char *const *inner_paths,
+									const char *const *file_paths,
+									int num_files,
+									int chunk_size,
+									int batch_size,
+									int num_readers,
+									int *num_pushed);
+
 /**
  * Pull a file from the database into the virtual file system.
  * @param file_system A pointer to the virtual file system.
@@ -84,6 +117,21 @@ MATRYOSHKA_EXPORT Status *Pull(FileSystem *file_system,
 							   FileHandle *inner_path,
 							   const char *file_path);
 
+/**
+ * Read a part of a file directly into a buffer provided by the caller.
+ * @param file_system A pointer to the virtual file system.
+ * @param file A handle to the file.
+ * @param offset The offset in the file in bytes.
+ * @param buffer The destination, which must be able to hold at least size bytes.
+ * @param size The number of bytes to read.
+ * @return A error ocurring during operation or nullptr on success.
+ */
+MATRYOSHKA_EXPORT Status *ReadInto(FileSystem *file_system,
+								   FileHandle *file,
+								   int64_t offset,
+								   void *buffer,
+								   int64_t size);
+
 /**
  * Search for a specific file(s).
  * @param file_system A pointer to the virtual file system.
@@ -101,7 +149,7 @@ MATRYOSHKA_EXPORT int Find(FileSystem *file_system,
  * @param file A handle to the file.
  * @return File size in bytes.
  */
-MATRYOSHKA_EXPORT int GetSize(FileSystem *file_system, FileHandle *file);
+MATRYOSHKA_EXPORT int64_t GetSize(FileSystem *file_system, FileHandle *file);
 
 /**
  * Delete a file. The file handle must not be used after the call but still needs to be freed.
@@ -111,6 +159,24 @@ MATRYOSHKA_EXPORT int GetSize(FileSystem *file_system, FileHandle *file);
  */
 MATRYOSHKA_EXPORT int Delete(FileSystem *file_system, FileHandle *file);
 
+/**
+ * Move a file or a folder with all its content to another path. No data is copied.
+ * @param file_system A pointer to the virtual file system.
+ * @param from The inner path of the existing file or folder.
+ * @param to The new inner path, which must not exist yet.
+ * @return A error ocurring during operation or nullptr on success.
+ */
+MATRYOSHKA_EXPORT Status *Move(FileSystem *file_system, const char *from, const char *to);
+
+/**
+ * Copy a file or a folder with all its content to another path. Deduplicated chunks are shared.
+ * @param file_system A pointer to the virtual file system.
+ * @param from The inner path of the existing file or folder.
+ * @param to The inner path of the copy, which must not exist yet.
+ * @return A error ocurring during operation or nullptr on success.
+ */
+MATRYOSHKA_EXPORT Status *Copy(FileSystem *file_system, const char *from, const char *to);
+
 };
 
 #endif //MATRYOSHKA_MATRYOSHKA_SHARED_API_H_
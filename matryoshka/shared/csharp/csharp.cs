@@ -31,6 +31,9 @@ namespace matryoshka {
         [DllImport("matryoshka.dll")]
         public static extern FileSystem* Load([MarshalAs(UnmanagedType.LPUTF8Str)] string path, Status** status);
 
+        [DllImport("matryoshka.dll")]
+        public static extern FileSystem* LoadWithProfile([MarshalAs(UnmanagedType.LPUTF8Str)] string path, [MarshalAs(UnmanagedType.LPUTF8Str)] string profile, Status** status);
+
         [DllImport("matryoshka.dll")]
         public static extern void DestroyFileSystem(FileSystem* file_system);
 
@@ -52,6 +55,9 @@ namespace matryoshka {
         [DllImport("matryoshka.dll")]
         public static extern Status* Pull(FileSystem* file_system, FileHandle* file, string path);
 
+        [DllImport("matryoshka.dll")]
+        public static extern Status* ReadInto(FileSystem* file_system, FileHandle* file, long offset, byte* buffer, long size);
+
         [DllImport("matryoshka.dll")]
         public static extern int Find(FileSystem* file_system, IntPtr path, [MarshalAs(UnmanagedType.FunctionPtr)]FindCallback callback);
 
@@ -59,7 +65,7 @@ namespace matryoshka {
         public static extern int Find(FileSystem* file_system, string path, [MarshalAs(UnmanagedType.FunctionPtr)]FindCallback callback);
 
         [DllImport("matryoshka.dll")]
-        public static extern int GetSize(FileSystem* file_system, FileHandle* file);
+        public static extern long GetSize(FileSystem* file_system, FileHandle* file);
 
         [DllImport("matryoshka.dll")]
         public static extern int Delete(FileSystem* file_system, FileHandle* file);
@@ -166,10 +172,10 @@ namespace matryoshka {
     public class FileSystem : IDisposable {
         private handles.FileSystemHandle handle_;
 
-        public FileSystem(string path) {
+        public FileSystem(string path, string profile = null) {
             unsafe {
                 Native.Status* status;
-                Native.FileSystem* file_system = Native.Load(path, &status);
+                Native.FileSystem* file_system = Native.LoadWithProfile(path, profile, &status);
                 if (file_system == null) {
                     using (handles.StatusHandle handle = new handles.StatusHandle(status)) {
                         throw new MatryoshkaException(handle);
@@ -265,13 +271,26 @@ namespace matryoshka {
             }
         }
 
+        public void Read(long offset, byte[] buffer) {
+            unsafe {
+                fixed (byte* destination = buffer) {
+                    Native.Status* status = Native.ReadInto(parent_.GetHandle(), handle_.GetHandle(), offset, destination, buffer.Length);
+                    if (status != null) {
+                        using (handles.StatusHandle handle = new handles.StatusHandle(status)) {
+                            throw new MatryoshkaException(handle);
+                        }
+                    }
+                }
+            }
+        }
+
         public bool Delete() {
             unsafe {
                 return Native.Delete(parent_.GetHandle(), handle_.GetHandle()) == 1;
             }
         }
 
-        public int Size {
+        public long Size {
             get {
                 unsafe {
                     return Native.GetSize(parent_.GetHandle(), handle_.GetHandle());
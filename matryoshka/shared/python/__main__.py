@@ -5,6 +5,7 @@ import faulthandler
 from matryoshka import Matryoshka
 from file_system import FileSystem
 from file import File
+from exception import MatryoshkaException
 
 
 class TestMatryoshka(unittest.TestCase):
@@ -48,6 +49,18 @@ class TestMatryoshka(unittest.TestCase):
 
         output_file.unlink()
 
+    def test_read(self):
+        example_path = Path("folder1", "file")
+
+        with FileSystem(":memory:", self.matryoshka) as fs:
+            with File.create(fs, example_path, self.example_file) as file:
+                self.assertEqual(file.read(), b"1234")
+                self.assertEqual(file.read(1, 2), b"23")
+
+                buffer = bytearray(3)
+                self.assertEqual(file.readinto(buffer, 1), 3)
+                self.assertEqual(buffer, b"234")
+
     def test_find(self):
         with FileSystem(":memory:", self.matryoshka) as fs:
             with File.create(fs, Path("folder1", "file"), self.example_file):
@@ -58,6 +71,15 @@ class TestMatryoshka(unittest.TestCase):
             files = File.find(fs, Path("folder*", "file"))
             self.assertEqual(len(files), 2)
 
+    def test_profile(self):
+        with FileSystem(":memory:", self.matryoshka, "durable") as fs:
+            with File.create(fs, Path("file"), self.example_file) as file:
+                self.assertEqual(file.read(), b"1234")
+
+        with self.assertRaises(MatryoshkaException):
+            with FileSystem(":memory:", self.matryoshka, "unknown"):
+                pass
+
 
 if __name__ == "__main__":
     faulthandler.enable()
@@ -130,9 +130,18 @@ class File(ApiElement):
             ctypes.c_char_p,
         )
 
-        matryoshka.library.GetSize.restype = ctypes.c_int
+        matryoshka.library.GetSize.restype = ctypes.c_int64
         matryoshka.library.GetSize.argtypes = (FileSystem.HANDLE_TYPE, File.HANDLE_TYPE)
 
+        matryoshka.library.ReadInto.restype = Status.HANDLE_TYPE
+        matryoshka.library.ReadInto.argtypes = (
+            FileSystem.HANDLE_TYPE,
+            File.HANDLE_TYPE,
+            ctypes.c_int64,
+            ctypes.c_void_p,
+            ctypes.c_int64,
+        )
+
     def __enter__(self):
         if not self.handle:
             with Status(self.file_system.matryoshka) as status:
@@ -176,6 +185,45 @@ class File(ApiElement):
             if status:
                 raise MatryoshkaException(status)
 
+    def readinto(self, buffer, offset: int = 0) -> int:
+        """
+        Read a part of the file directly into a writable buffer, i.e. a bytearray.
+        :param buffer: The buffer which is filled completely.
+        :param offset: The offset in the file.
+        :return: The number of bytes read.
+        """
+
+        if not self:
+            raise ValueError("The file is not open")
+
+        size = len(buffer)
+        raw_buffer = (ctypes.c_char * size).from_buffer(buffer)
+        with Status(
+            self.matryoshka,
+            self.matryoshka.library.ReadInto(
+                self.file_system.handle, self.handle, offset, raw_buffer, size
+            ),
+        ) as status:
+            if status:
+                raise MatryoshkaException(status)
+
+        return size
+
+    def read(self, offset: int = 0, size: int = -1) -> bytes:
+        """
+        Read a part of the file into memory.
+        :param offset: The offset in the file.
+        :param size: The number of bytes to read. Values < 0 read until the end of the file.
+        :return: The content.
+        """
+
+        if size < 0:
+            size = self.size - offset
+
+        buffer = bytearray(size)
+        self.readinto(buffer, offset)
+        return bytes(buffer)
+
     @property
     def size(self) -> int:
         """
@@ -1,4 +1,5 @@
 import ctypes
+from typing import Optional
 
 from matryoshka import Matryoshka
 from status import Status
@@ -17,23 +18,26 @@ class FileSystem(ApiElement):
     # The underlying type of handle
     HANDLE_TYPE = ctypes.POINTER(FileSystem)
 
-    def __init__(self, path: str, matryoshka: Matryoshka):
+    def __init__(self, path: str, matryoshka: Matryoshka, profile: Optional[str] = None):
         """
         Create an instance referring to an existing SQLite database.
         WARNING: The file system is not yet open nor created! Use __enter__.
 
         :param path: The path to the database.
         :param matryoshka: The shared library.
+        :param profile: The database tuning, i.e. "default", "bulk-import", "read-mostly" or "durable".
         """
 
         super().__init__(matryoshka)
         self.path = path
+        self.profile = profile
         self.handle = FileSystem.HANDLE_TYPE()
 
     @classmethod
     def initialize(cls, matryoshka: Matryoshka):
-        matryoshka.library.Load.restype = FileSystem.HANDLE_TYPE
-        matryoshka.library.Load.argtypes = [
+        matryoshka.library.LoadWithProfile.restype = FileSystem.HANDLE_TYPE
+        matryoshka.library.LoadWithProfile.argtypes = [
+            ctypes.c_char_p,
             ctypes.c_char_p,
             ctypes.POINTER(Status.HANDLE_TYPE),
         ]
@@ -45,8 +49,10 @@ class FileSystem(ApiElement):
     def __enter__(self):
         if not self.handle:
             with Status(self.matryoshka) as status:
-                self.handle = self.matryoshka.library.Load(
-                    self.path.encode("ascii"), ctypes.byref(status.handle)
+                self.handle = self.matryoshka.library.LoadWithProfile(
+                    self.path.encode("ascii"),
+                    self.profile.encode("ascii") if self.profile is not None else None,
+                    ctypes.byref(status.handle),
                 )
                 if not self.handle:
                     self.handle = Status.HANDLE_TYPE()
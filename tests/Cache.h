@@ -74,6 +74,43 @@ TEST_CASE ("Writing") {
   CHECK(!cache);
   CHECK(cache.Size() == 0);
 }
+
+TEST_CASE ("Content-defined boundaries") {
+  Cache::Chunk data(20000);
+  std::uint32_t state = 42;
+  for (Cache::SizeType i = 0; i < data.Size(); ++i) {
+	state = state * 1664525u + 1013904223u;
+	data[i] = static_cast<unsigned char>(state >> 24u);
+  }
+
+  // The boundaries of the data as a whole
+  const auto parameters = Chunker::Parameters::Create(1024);
+  std::vector<Cache::SizeType> expected;
+  Chunker chunker(parameters);
+  for (Cache::SizeType onset = 0, length; onset < data.Size(); onset += length) {
+	length = chunker.Update(data.Data() + onset, data.Size() - onset);
+	if (length < 0) {
+	  break;
+	}
+	CHECK(length >= parameters.minimal_size);
+	CHECK(length <= parameters.maximal_size);
+	expected.push_back(length);
+  }
+  REQUIRE(expected.size() > 2);
+
+  // The boundaries are the same, no matter how the data arrives in the cache
+  Cache cache;
+  Chunker cache_chunker(parameters);
+  std::vector<Cache::SizeType> found;
+  for (Cache::SizeType onset = 0; onset < data.Size(); onset += 777) {
+	cache.Push(Cache::Chunk(data.Part(std::min<Cache::SizeType>(777, data.Size() - onset), onset)));
+	for (Cache::SizeType length; (length = cache.Find(cache_chunker)) > 0;) {
+	  found.push_back(length);
+	  CHECK(cache.Pop(length).Size() == length);
+	}
+  }
+  CHECK(found == expected);
+}
 }
 
 #endif //MATRYOSHKA_TESTS_CACHE_H_
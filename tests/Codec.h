@@ -0,0 +1,82 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_TESTS_CODEC_H_
+#define MATRYOSHKA_TESTS_CODEC_H_
+
+#include "../matryoshka/data/util/Codec.h"
+
+#include <string>
+
+using namespace matryoshka::data::util;
+
+TEST_SUITE ("Codec") {
+TEST_CASE ("Round trip") {
+  auto check_round_trip = [](const sqlite::BlobBase &data) {
+	auto encoded = Codec::Encode(Codec::Type::Lz, data);
+	CHECK(encoded.Size() <= data.Size() + 1);
+
+	sqlite::Blob<true> decoded;
+	REQUIRE(Codec::Decode(encoded.Data(), encoded.Size(), decoded));
+	CHECK(decoded.Size() == data.Size());
+	CHECK((data.Size() == 0 || std::memcmp(decoded.Data(), data.Data(), data.Size()) == 0));
+	return encoded.Size();
+  };
+
+  SUBCASE("Text") {
+	std::string text;
+	for (int i = 0; text.size() < 100000; ++i) {
+	  text += R"({"level": "info", "message": "Request )" + std::to_string(i) + R"( handled", "status": 200})" "\n";
+	}
+	const sqlite::Blob<false> data(reinterpret_cast<const unsigned char *>(text.data()), text.size());
+	CHECK(check_round_trip(data) * 4 < data.Size());
+  }
+
+  SUBCASE("Runs") {
+	CHECK(check_round_trip(sqlite::Blob<true>::Filled(70000, 42)) < 1000);
+	CHECK(check_round_trip(sqlite::Blob<true>::Filled(17, 1)) <= 18);
+  }
+
+  SUBCASE("Incompressible") {
+	sqlite::Blob<true> data(5000);
+	std::uint32_t state = 42;
+	for (sqlite::BlobBase::SizeType i = 0; i < data.Size(); ++i) {
+	  state = state * 1664525u + 1013904223u;
+	  data[i] = static_cast<unsigned char>(state >> 24u);
+	}
+	CHECK(check_round_trip(data) == data.Size() + 1);
+  }
+
+  SUBCASE("Tiny") {
+	CHECK(check_round_trip(sqlite::Blob<true>()) == 1);
+	CHECK(check_round_trip(sqlite::Blob<true>::Filled(3, 7)) == 4);
+  }
+}
+
+TEST_CASE ("Corruption") {
+  std::string text(2000, 'a');
+  const sqlite::Blob<false> data(reinterpret_cast<const unsigned char *>(text.data()), text.size());
+  auto encoded = Codec::Encode(Codec::Type::Lz, data);
+  REQUIRE(encoded.Size() < data.Size());
+
+  sqlite::Blob<true> decoded;
+  CHECK(!Codec::Decode(encoded.Data(), 0, decoded));
+  CHECK(!Codec::Decode(encoded.Data(), encoded.Size() / 2, decoded));
+
+  encoded[0] = 42;
+  CHECK(!Codec::Decode(encoded.Data(), encoded.Size(), decoded));
+}
+
+TEST_CASE ("Flags") {
+  CHECK(Codec::FromFlags(0) == Codec::Type::Store);
+  CHECK(Codec::FromFlags(Codec::ToFlags(Codec::Type::Lz) | 3) == Codec::Type::Lz);
+  CHECK((Codec::ToFlags(Codec::Type::Lz) & 3) == 0);
+}
+}
+
+#endif //MATRYOSHKA_TESTS_CODEC_H_
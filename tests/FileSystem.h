@@ -10,10 +10,14 @@ You should have received a copy of the GNU Affero General Public License along w
 #define MATRYOSHKA_TESTS_FILESYSTEM_H_
 
 #include <filesystem>
+#include <thread>
+#include <atomic>
 
 #include <doctest/doctest.h>
 
 #include "../matryoshka/data/FileSystem.h"
+#include "../matryoshka/data/FileSystemPool.h"
+#include "../matryoshka/data/Importer.h"
 #include "../matryoshka/data/Path.h"
 
 TEST_SUITE ("FileSystem") {
@@ -108,6 +112,13 @@ TEST_CASE ("Reading") {
   REQUIRE_MESSAGE(!read_status.has_value(), read_status);
   CHECK(Blob<true>("test2.tmp") == data);
 
+  // Appending places the data behind the current end, which is not aligned to any page
+  read_status = file_system.Read(file, "test2.tmp", 0, data.Size(), false);
+  REQUIRE_MESSAGE(!read_status.has_value(), read_status);
+  Blob<true> appended("test2.tmp");
+  REQUIRE(appended.Size() == 2 * data.Size());
+  CHECK(Blob<true>(appended.Part(data.Size(), data.Size())) == data);
+
   // Check direct read from database to local file system with an non-existing folder
   CHECK(!file_system.Read(file, "nonexisting_folder/test2.tmp", 0, data.Size(), true, true).has_value());
   CHECK(Blob<true>("nonexisting_folder/test2.tmp") == data);
@@ -178,6 +189,21 @@ TEST_CASE ("Reading") {
   CHECK(read_blob->operator[](0) == 15);
   CHECK(read_blob->operator[](1) == 16);
 
+  // Read directly into caller-provided memory, scattered across chunk borders
+  unsigned char first_part[3] = {0}, second_part[20] = {0}, third_part[1] = {0};
+  const FileSystem::Buffer buffers[] = {{first_part, 3}, {second_part, 20}, {third_part, 1}};
+  CHECK(!file_system.Read(file, 13, buffers, 3));
+  CHECK(first_part[0] == 13);
+  CHECK(first_part[2] == 15);
+  CHECK(second_part[0] == 16);
+  CHECK(second_part[19] == 35);
+  CHECK(third_part[0] == 36);
+
+  unsigned char full_data[42] = {0};
+  CHECK(!file_system.Read(file, 0, full_data, 42));
+  CHECK(Blob<false>(full_data, 42) == data);
+  CHECK(file_system.Read(file, 40, full_data, 4).value() == Error(errors::Io::OutOfBounds));
+
   // Check delete in all different chunked conditions
   Path second_file("second_file/no_delete");
   REQUIRE(file_system.Create(second_file, data.Copy()));
@@ -186,6 +212,46 @@ TEST_CASE ("Reading") {
   CHECK(file_system.Open(second_file));
 }
 
+TEST_CASE ("Stream") {
+  auto database = std::get<Database>(Database::Create());
+  auto file_system_container = FileSystem::Open(std::move(database));
+  REQUIRE_MESSAGE(file_system_container, file_system_container);
+  auto file_system = std::get<FileSystem>(std::move(file_system_container));
+
+  sqlite::Blob<true> data(42);
+  for (unsigned char i = 0, size = data.Size(); i < size; ++i) {
+	data[i] = i;
+  }
+  auto file = std::get<File>(file_system.Create(Path("file"), data.Copy(), 16));
+  auto stream_container = file_system.Stream(file);
+  REQUIRE_MESSAGE(stream_container, stream_container);
+  auto stream = std::get<FileStream>(std::move(stream_container));
+  CHECK(stream.Size() == 42);
+
+  // Read sequentially in small pieces, crossing the chunk borders
+  unsigned char buffer[42] = {0};
+  for (int i = 0; i < 42; i += 5) {
+	auto bytes_read = stream.Read(buffer + i, 5);
+	REQUIRE(bytes_read);
+	CHECK(std::get<FileStream::SizeType>(bytes_read) == std::min(5, 42 - i));
+	CHECK(stream.Tell() == std::min(i + 5, 42));
+  }
+  CHECK(Blob<false>(buffer, 42) == data);
+  CHECK(std::get<FileStream::SizeType>(stream.Read(buffer, 1)) == 0);
+
+  // Read at random positions
+  unsigned char byte = 0;
+  CHECK(std::get<FileStream::SizeType>(stream.Read(17, &byte, 1)) == 1);
+  CHECK(byte == 17);
+  CHECK(std::get<FileStream::SizeType>(stream.Read(3, &byte, 1)) == 1);
+  CHECK(byte == 3);
+  CHECK(std::get<FileStream::SizeType>(stream.Read(14, buffer, 20)) == 20);
+  CHECK(Blob<false>(buffer, 20) == Blob<true>(data.Part(20, 14)));
+
+  CHECK(!stream.Seek(43));
+  CHECK(stream.Read(43, buffer, 1) == Error(errors::Io::OutOfBounds));
+}
+
 TEST_CASE ("Multiple files") {
   auto database = std::get<Database>(Database::Create());
   auto file_system_container = FileSystem::Open(std::move(database));
@@ -258,6 +324,903 @@ TEST_CASE ("Multiple files") {
   CHECK(std::find(paths.begin(), paths.end(), path_5) != paths.end());
 }
 
+TEST_CASE ("Migration") {
+  // Create a container in the layout of version 0
+  auto database = std::get<Database>(Database::Create());
+  REQUIRE(database(
+	  "CREATE TABLE Matryoshka_Meta_0 (id INTEGER PRIMARY KEY, path TEXT UNIQUE NOT NULL, type INTEGER, flags INTEGER, chunk_size INTEGER NOT NULL)"));
+  REQUIRE(database(
+	  "CREATE TABLE Matryoshka_Data (chunk_id INTEGER PRIMARY KEY, file_id INTEGER NOT NULL, chunk_num INTEGER NOT NULL, data BLOB NOT NULL, CONSTRAINT unq UNIQUE (file_id, chunk_num), FOREIGN KEY(file_id) REFERENCES Matryoshka_Meta_0 (id) ON DELETE CASCADE ON UPDATE CASCADE)"));
+  REQUIRE(database(
+	  "INSERT INTO Matryoshka_Meta_0 (id, path, type, chunk_size) VALUES (1, 'a', 1, 4), (2, 'b', 1, 4), (3, 'x/y/z', 1, 4)"));
+  REQUIRE(database("INSERT INTO Matryoshka_Data (file_id, chunk_num, data) VALUES (1, 0, x'00010203'), (1, 1, x'0405')"));
+
+  auto file_system_container = FileSystem::Open(std::move(database));
+  REQUIRE_MESSAGE(file_system_container, file_system_container);
+  auto file_system = std::get<FileSystem>(std::move(file_system_container));
+
+  // Check the sizes were derived from the existing chunks
+  auto file_a = std::get<File>(file_system.Open(Path("a")));
+  auto file_b = std::get<File>(file_system.Open(Path("b")));
+  CHECK(file_system.Size(file_a) == 6);
+  CHECK(file_system.Size(file_b) == 0);
+  auto metadata = file_system.Stat(file_b);
+  REQUIRE(metadata);
+  CHECK(!metadata->modified.has_value());
+  CHECK(!metadata->hash.has_value());
+
+  // Check the folders implied by the paths were created
+  auto folder = file_system.List(Path("x/y"));
+  REQUIRE(folder);
+  REQUIRE(std::get<std::vector<FileSystem::Entry>>(folder).size() == 1);
+  CHECK(std::get<std::vector<FileSystem::Entry>>(folder)[0].name == "z");
+  auto root = file_system.List(Path(""));
+  REQUIRE(root);
+  CHECK(std::get<std::vector<FileSystem::Entry>>(root).size() == 3);
+
+  auto read_blob = file_system.Read(file_a, 3, 2);
+  REQUIRE(read_blob);
+  CHECK(read_blob->operator[](0) == 3);
+  CHECK(read_blob->operator[](1) == 4);
+
+  // Check the data is still bound to the migrated meta table
+  REQUIRE(file_system.Delete(std::move(file_a)));
+  CHECK(file_system.Create(Path("a"), Blob<true>::Filled(3), 2));
+  file_a = std::get<File>(file_system.Open(Path("a")));
+  CHECK(file_system.Size(file_a) == 3);
+
+  // Check deduplication is available in migrated containers
+  file_system.SetWriteOptions(FileSystem::WriteOptions().SetDeduplicate(true));
+  REQUIRE(file_system.Create(Path("c"), Blob<true>::Filled(4, 7), 2));
+  auto statistics = file_system.Deduplication();
+  REQUIRE(statistics);
+  CHECK(statistics->references == 2);
+  CHECK(statistics->unique_chunks == 1);
+}
+
+TEST_CASE ("Deduplication") {
+  auto database = std::get<Database>(Database::Create());
+  auto file_system_container = FileSystem::Open(std::move(database));
+  REQUIRE_MESSAGE(file_system_container, file_system_container);
+  auto file_system = std::get<FileSystem>(std::move(file_system_container));
+  CHECK(!file_system.GetWriteOptions().deduplicate);
+  file_system.SetWriteOptions(FileSystem::WriteOptions().SetDeduplicate(true));
+
+  Blob<true> data(40);
+  for (int i = 0; i < data.Size(); ++i) {
+	data[i] = static_cast<unsigned char>(i % 10);
+  }
+
+  // Four identical chunks in the first file, and the same chunks again in the second one
+  auto file_1 = std::get<File>(file_system.Create(Path("file_1"), data.Copy(), 10));
+  auto chunk_source = [&data, index = FileSystem::SizeType(0)](int size) mutable {
+	auto chunk = Blob<true>(data.Part(size, index));
+	index += size;
+	return chunk;
+  };
+  auto file_2 = std::get<File>(file_system.Create(Path("file_2"), chunk_source, data.Size(), 10));
+
+  auto statistics = file_system.Deduplication();
+  REQUIRE(statistics);
+  CHECK(statistics->references == 8);
+  CHECK(statistics->unique_chunks == 1);
+  CHECK(statistics->logical_size == 80);
+  CHECK(statistics->stored_size == 10);
+  CHECK(statistics->Ratio() == 8.0);
+
+  // Check the content is read from the shared chunks
+  auto read_blob = file_system.Read(file_2, 5, 20);
+  REQUIRE(read_blob);
+  CHECK(read_blob == Blob<true>(data.Part(20, 5)));
+
+  unsigned char buffer[40];
+  REQUIRE(!file_system.Read(file_1, 0, buffer, 40).has_value());
+  CHECK(std::memcmp(buffer, data.Data(), 40) == 0);
+
+  auto stream = std::get<FileStream>(file_system.Stream(file_1));
+  CHECK(stream.Read(35, buffer, 5) == FileStream::SizeType(5));
+  CHECK(std::memcmp(buffer, data.Data() + 35, 5) == 0);
+
+  // Files written without deduplication are unaffected
+  file_system.SetWriteOptions(FileSystem::WriteOptions());
+  auto file_3 = std::get<File>(file_system.Create(Path("file_3"), data.Copy(), 10));
+  CHECK(file_system.Read(file_3, 0, 40) == data);
+  CHECK(file_system.Deduplication()->references == 8);
+
+  // Shared chunks survive until the last reference is gone
+  REQUIRE(file_system.Delete(std::move(file_1)));
+  statistics = file_system.Deduplication();
+  CHECK(statistics->references == 4);
+  CHECK(statistics->unique_chunks == 1);
+  CHECK(file_system.Read(file_2, 0, 40) == data);
+
+  REQUIRE(file_system.Delete(std::move(file_2)));
+  statistics = file_system.Deduplication();
+  CHECK(statistics->references == 0);
+  CHECK(statistics->unique_chunks == 0);
+  CHECK(statistics->Ratio() == 1.0);
+}
+
+TEST_CASE ("Content-defined chunking") {
+  auto database = std::get<Database>(Database::Create());
+  auto file_system_container = FileSystem::Open(std::move(database));
+  REQUIRE_MESSAGE(file_system_container, file_system_container);
+  auto file_system = std::get<FileSystem>(std::move(file_system_container));
+  file_system.SetWriteOptions(
+	  FileSystem::WriteOptions()
+		  .SetDeduplicate(true)
+		  .SetContentDefinedChunking(util::Chunker::Parameters::Create(1024)));
+
+  Blob<true> data(64 * 1024), shifted_data(data.Size() + 1);
+  std::uint32_t state = 42;
+  for (FileSystem::SizeType i = 0; i < data.Size(); ++i) {
+	state = state * 1664525u + 1013904223u;
+	data[i] = static_cast<unsigned char>(state >> 24u);
+  }
+
+  // Insert a single byte in the middle of the data
+  const FileSystem::SizeType insertion = data.Size() / 2;
+  std::memcpy(shifted_data.Data(), data.Data(), insertion);
+  shifted_data[insertion] = 42;
+  std::memcpy(shifted_data.Data() + insertion + 1, data.Data() + insertion, data.Size() - insertion);
+
+  auto file_1 = std::get<File>(file_system.Create(Path("file_1"), data.Copy()));
+  const auto references = file_system.Deduplication()->references;
+  CHECK(references > 16);
+
+  // The boundaries do not depend on the way the data is passed
+  auto chunk_source = [&shifted_data, index = FileSystem::SizeType(0)](int size) mutable {
+	size = std::min(size, 1000);
+	auto chunk = Blob<true>(shifted_data.Part(size, index));
+	index += size;
+	return chunk;
+  };
+  auto file_2 = std::get<File>(file_system.Create(Path("file_2"), chunk_source, shifted_data.Size()));
+  CHECK(file_system.Size(file_2) == shifted_data.Size());
+
+  // Only the chunks around the insertion are stored again
+  auto statistics = file_system.Deduplication();
+  REQUIRE(statistics);
+  CHECK(statistics->unique_chunks <= references + 2);
+
+  // Local files are chunked identically, so they only add references
+  const std::string local_file_path = "content_defined.tmp";
+  REQUIRE(shifted_data.Save(local_file_path, false));
+  auto file_4 = std::get<File>(file_system.Create(Path("file_4"), local_file_path));
+  CHECK(file_system.Deduplication()->unique_chunks == statistics->unique_chunks);
+  CHECK(file_system.Read(file_4, 0, shifted_data.Size()) == shifted_data);
+  std::filesystem::remove(local_file_path);
+
+  // Check reading across the variable boundaries
+  CHECK(file_system.Read(file_1, 0, data.Size()) == data);
+  CHECK(file_system.Read(file_2, 0, shifted_data.Size()) == shifted_data);
+  for (FileSystem::SizeType start = 0; start < shifted_data.Size(); start += 3001) {
+	const auto length = std::min<FileSystem::SizeType>(5000, shifted_data.Size() - start);
+	CHECK(file_system.Read(file_2, start, length) == Blob<true>(shifted_data.Part(length, start)));
+  }
+  CHECK(file_system.Read(file_2, shifted_data.Size(), 1) == Error(errors::Io::OutOfBounds));
+
+  unsigned char buffer[100];
+  auto stream = std::get<FileStream>(file_system.Stream(file_2));
+  for (FileSystem::SizeType start = shifted_data.Size() - 100; start > 0; start -= 4321) {
+	REQUIRE(stream.Read(start, buffer, 100) == FileStream::SizeType(100));
+	CHECK(std::memcmp(buffer, shifted_data.Data() + start, 100) == 0);
+  }
+  REQUIRE(stream.Seek(0));
+  for (FileSystem::SizeType start = 0; start + 100 <= shifted_data.Size(); start += 100) {
+	REQUIRE(stream.Read(buffer, 100) == FileStream::SizeType(100));
+	CHECK(std::memcmp(buffer, shifted_data.Data() + start, 100) == 0);
+  }
+
+  // Fixed-size files are unaffected
+  file_system.SetWriteOptions(FileSystem::WriteOptions());
+  auto file_3 = std::get<File>(file_system.Create(Path("file_3"), data.Copy(), 1000));
+  CHECK(file_system.Read(file_3, 999, 1002) == Blob<true>(data.Part(1002, 999)));
+}
+
+TEST_CASE ("Compression") {
+  std::string text;
+  for (int i = 0; text.size() < 200000; ++i) {
+	text += R"({"level": "debug", "message": "Chunk )" + std::to_string(i) + R"( written", "elapsed": 0.)"
+		+ std::to_string(i % 97) + "}\n";
+  }
+  Blob<true> data(static_cast<FileSystem::SizeType>(text.size()));
+  std::memcpy(data.Data(), text.data(), text.size());
+
+  // Write the same content into an uncompressed and a compressed container
+  FileSystem::SizeType container_sizes[2] = {0, 0};
+  for (int i = 0; i < 2; ++i) {
+	const std::string container_path = "compressed_container_" + std::to_string(i) + ".tmp";
+	std::ofstream(container_path, std::ofstream::binary | std::ofstream::trunc).close();
+	{
+	  auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create(container_path))));
+	  file_system.SetWriteOptions(
+		  FileSystem::WriteOptions().SetCodec(i == 0 ? util::Codec::Type::Store : util::Codec::Type::Lz));
+	  auto file = std::get<File>(file_system.Create(Path("log.json"), data.Copy(), 16384));
+	  CHECK(file_system.Size(file) == data.Size());
+
+	  // Check random reads decode the touched chunks only
+	  CHECK(file_system.Read(file, 0, data.Size()) == data);
+	  for (FileSystem::SizeType start = 0; start < data.Size(); start += 7777) {
+		const auto length = std::min<FileSystem::SizeType>(20000, data.Size() - start);
+		CHECK(file_system.Read(file, start, length) == Blob<true>(data.Part(length, start)));
+	  }
+
+	  unsigned char buffer[300];
+	  REQUIRE(!file_system.Read(file, 16300, buffer, 300).has_value());
+	  CHECK(std::memcmp(buffer, data.Data() + 16300, 300) == 0);
+
+	  auto stream = std::get<FileStream>(file_system.Stream(file));
+	  CHECK(stream.Read(data.Size() - 300, buffer, 300) == FileStream::SizeType(300));
+	  CHECK(std::memcmp(buffer, data.Data() + data.Size() - 300, 300) == 0);
+	  CHECK(stream.Read(100, buffer, 300) == FileStream::SizeType(300));
+	  CHECK(std::memcmp(buffer, data.Data() + 100, 300) == 0);
+	}
+	container_sizes[i] = std::filesystem::file_size(container_path);
+	std::filesystem::remove(container_path);
+  }
+  CHECK(container_sizes[1] * 2 < container_sizes[0]);
+
+  // Chunks which do not shrink are stored as they are, also when shared between files
+  auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create())));
+  file_system.SetWriteOptions(
+	  FileSystem::WriteOptions()
+		  .SetDeduplicate(true)
+		  .SetContentDefinedChunking(util::Chunker::Parameters::Create(1024))
+		  .SetCodec(util::Codec::Type::Lz));
+  Blob<true> random_data(10000);
+  std::uint32_t state = 42;
+  for (FileSystem::SizeType i = 0; i < random_data.Size(); ++i) {
+	state = state * 1664525u + 1013904223u;
+	random_data[i] = static_cast<unsigned char>(state >> 24u);
+  }
+  auto random_file = std::get<File>(file_system.Create(Path("random"), random_data.Copy()));
+  auto text_file = std::get<File>(file_system.Create(Path("text"), data.Copy()));
+  CHECK(file_system.Read(random_file, 1234, 5678) == Blob<true>(random_data.Part(5678, 1234)));
+  CHECK(file_system.Read(text_file, 4321, 56789) == Blob<true>(data.Part(56789, 4321)));
+}
+
+TEST_CASE ("Modification") {
+  const FileSystem::WriteOptions options[] = {
+	  FileSystem::WriteOptions(),
+	  FileSystem::WriteOptions().SetDeduplicate(true),
+	  FileSystem::WriteOptions().SetCodec(util::Codec::Type::Lz),
+	  FileSystem::WriteOptions().SetDeduplicate(true).SetContentDefinedChunking(util::Chunker::Parameters::Create(512)),
+  };
+
+  Blob<true> data(10000), patch(3000);
+  std::uint32_t state = 42;
+  for (FileSystem::SizeType i = 0; i < data.Size(); ++i) {
+	state = state * 1664525u + 1013904223u;
+	data[i] = static_cast<unsigned char>(state >> 24u);
+	if (i < patch.Size()) {
+	  patch[i] = static_cast<unsigned char>(i % 7);
+	}
+  }
+
+  for (const auto &option : options) {
+	auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create())));
+	file_system.SetWriteOptions(option);
+	auto file = std::get<File>(file_system.Create(Path("file"), data.Copy(), 1000));
+	auto copy = std::get<File>(file_system.Create(Path("copy"), data.Copy(), 1000));
+	std::vector<unsigned char> expected(data.Data(), data.Data() + data.Size());
+	auto check = [&]() {
+	  REQUIRE(file_system.Size(file) == FileSystem::SizeType(expected.size()));
+	  const auto content = file_system.Read(file, 0, expected.size());
+	  REQUIRE(content);
+	  CHECK(std::memcmp(std::get<Blob<true>>(content).Data(), expected.data(), expected.size()) == 0);
+
+	  unsigned char buffer[100];
+	  auto stream = std::get<FileStream>(file_system.Stream(file));
+	  for (std::size_t start = 0; start + 100 <= expected.size(); start += 1234) {
+		REQUIRE(stream.Read(start, buffer, 100) == FileStream::SizeType(100));
+		CHECK(std::memcmp(buffer, expected.data() + start, 100) == 0);
+	  }
+	};
+
+	// Overwrite across chunk boundaries and beyond the end
+	REQUIRE(!file_system.Write(file, 500, patch.Part(2000)).has_value());
+	std::memcpy(expected.data() + 500, patch.Data(), 2000);
+	check();
+	REQUIRE(!file_system.Write(file, 9000, patch.Copy()).has_value());
+	expected.resize(12000);
+	std::memcpy(expected.data() + 9000, patch.Data(), 3000);
+	check();
+	CHECK(file_system.Write(file, 12001, patch.Copy()) == Error(errors::Io::OutOfBounds));
+
+	// Append to a partially filled last chunk
+	REQUIRE(!file_system.Append(file, data.Part(1500)).has_value());
+	expected.insert(expected.end(), data.Data(), data.Data() + 1500);
+	check();
+	REQUIRE(!file_system.Append(file, data.Part(10, 77)).has_value());
+	expected.insert(expected.end(), data.Data() + 77, data.Data() + 87);
+	check();
+
+	// Shrink within a chunk and at its boundary
+	REQUIRE(!file_system.Truncate(file, 4321).has_value());
+	expected.resize(4321);
+	check();
+	REQUIRE(!file_system.Truncate(file, 4000).has_value());
+	expected.resize(4000);
+	check();
+	CHECK(file_system.Truncate(file, 4001) == Error(errors::Io::OutOfBounds));
+
+	// Grow an emptied file again
+	REQUIRE(!file_system.Truncate(file, 0).has_value());
+	expected.clear();
+	CHECK(file_system.Size(file) == 0);
+	REQUIRE(!file_system.Append(file, data.Part(3000)).has_value());
+	REQUIRE(!file_system.Write(file, 2000, data.Copy()).has_value());
+	expected.assign(data.Data(), data.Data() + 2000);
+	expected.insert(expected.end(), data.Data(), data.Data() + data.Size());
+	check();
+
+	// Shared chunks of other files are unaffected
+	CHECK(file_system.Read(copy, 0, data.Size()) == data);
+  }
+}
+
+TEST_CASE ("Streamed chunks") {
+  auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create())));
+  file_system.SetWriteOptions(FileSystem::WriteOptions().SetBufferSize(100));
+
+  Blob<true> data(10000);
+  for (FileSystem::SizeType i = 0; i < data.Size(); ++i) {
+	data[i] = static_cast<unsigned char>(i * 31 % 251);
+  }
+
+  // The source is never asked for more than the buffer, regardless of the chunk size
+  int maximal_request = 0;
+  auto chunk_source = [&, index = FileSystem::SizeType(0)](int size) mutable {
+	maximal_request = std::max(maximal_request, size);
+	size = std::min(size, 77);
+	auto chunk = Blob<true>(data.Part(size, index));
+	index += size;
+	return chunk;
+  };
+  auto file = std::get<File>(file_system.Create(Path("streamed"), chunk_source, data.Size(), 4096));
+  CHECK(maximal_request == 100);
+  CHECK(file_system.Size(file) == data.Size());
+  CHECK(file_system.Read(file, 0, data.Size()) == data);
+  CHECK(file_system.Read(file, 4000, 200) == Blob<true>(data.Part(200, 4000)));
+
+  // Local files are streamed in the same pieces
+  const std::string local_file_path = "streamed.tmp";
+  REQUIRE(data.Save(local_file_path, false));
+  auto local_file = std::get<File>(file_system.Create(Path("streamed_local"), local_file_path, 4096));
+  CHECK(file_system.Read(local_file, 0, data.Size()) == data);
+  CHECK(file_system.Stat(local_file)->hash == file_system.Stat(file)->hash);
+  std::filesystem::remove(local_file_path);
+
+  // Aborting leaves no file behind
+  auto failing_source = [](int) {
+	return Blob<true>();
+  };
+  CHECK(!file_system.Create(Path("aborted"), failing_source, data.Size(), 4096));
+  CHECK(!file_system.Open(Path("aborted")));
+}
+
+TEST_CASE ("Metadata") {
+  auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create())));
+  Blob<true> data(5000);
+  for (FileSystem::SizeType i = 0; i < data.Size(); ++i) {
+	data[i] = static_cast<unsigned char>(i * 13 % 256);
+  }
+  const std::string expected_hash = util::Sha256::ToHex(util::Sha256::Hash(data));
+
+  // Both ways of creating a file store the hash of its content
+  auto file = std::get<File>(file_system.Create(Path("file"), data.Copy(), 1000));
+  auto streamed = std::get<File>(file_system.Create(Path("streamed"),
+													[&, index = FileSystem::SizeType(0)](int size) mutable {
+													  auto chunk = Blob<true>(data.Part(size, index));
+													  index += size;
+													  return chunk;
+													}, data.Size(), 1000));
+  for (const File *handle : {&file, &streamed}) {
+	auto metadata = file_system.Stat(*handle);
+	REQUIRE(metadata);
+	CHECK(metadata->size == data.Size());
+	REQUIRE(metadata->hash.has_value());
+	CHECK(metadata->hash.value() == expected_hash);
+	REQUIRE(metadata->modified.has_value());
+	CHECK(metadata->modified.value() > 0);
+  }
+
+  // Modifications keep the time current but discard the hash
+  const auto created = file_system.Stat(file)->modified.value();
+  REQUIRE(!file_system.Append(file, data.Part(10)).has_value());
+  auto metadata = file_system.Stat(file);
+  REQUIRE(metadata);
+  CHECK(metadata->size == data.Size() + 10);
+  CHECK(!metadata->hash.has_value());
+  CHECK(metadata->modified.value() >= created);
+  CHECK(file_system.Stat(streamed)->hash.value() == expected_hash);
+}
+
+TEST_CASE ("Listing") {
+  auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create())));
+  for (const auto *path : {"a", "dir/b", "dir/c", "dir/sub/d", "dir/sub/deeper/e", "dir/z", "dir!x", "dirz/f"}) {
+	REQUIRE(file_system.Create(Path(path), Blob<true>::Filled(std::string_view(path).size()), 4));
+  }
+  auto names = [](const std::vector<FileSystem::Entry> &entries) {
+	std::vector<std::string> result;
+	for (const auto &entry : entries) {
+	  result.emplace_back(entry.is_folder ? entry.name + "/" : entry.name);
+	}
+	return result;
+  };
+
+  auto root = file_system.List(Path(""));
+  REQUIRE(root);
+  CHECK(names(std::get<std::vector<FileSystem::Entry>>(root))
+			== std::vector<std::string>{"a", "dir/", "dir!x", "dirz/"});
+
+  // Files carry their metadata, while folders only know their time of creation
+  auto folder = file_system.List(Path("/dir/"));
+  REQUIRE(folder);
+  const auto &entries = std::get<std::vector<FileSystem::Entry>>(folder);
+  CHECK(names(entries) == std::vector<std::string>{"b", "c", "sub/", "z"});
+  CHECK(entries[0].metadata.size == 5);
+  CHECK(entries[0].metadata.hash.has_value());
+  CHECK(entries[0].metadata.modified.has_value());
+  CHECK(entries[2].metadata.size == 0);
+  CHECK(entries[2].metadata.modified.has_value());
+
+  auto nested = file_system.List(Path("dir/sub"));
+  REQUIRE(nested);
+  CHECK(names(std::get<std::vector<FileSystem::Entry>>(nested)) == std::vector<std::string>{"d", "deeper/"});
+
+  CHECK(!file_system.List(Path("dir/b")));
+  CHECK(!file_system.List(Path("missing")));
+}
+
+TEST_CASE ("Folders") {
+  auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create())));
+  file_system.SetWriteOptions(FileSystem::WriteOptions().SetDeduplicate(true));
+  REQUIRE(file_system.Create(Path("a/b/file"), Blob<true>::Filled(10, 1), 4));
+  REQUIRE(file_system.Create(Path("a/other"), Blob<true>::Filled(10, 1), 4));
+
+  // Creating a file creates its parents, which are reused afterwards
+  auto folder = file_system.OpenFolder(Path("a/b"));
+  REQUIRE(folder);
+  CHECK(file_system.OpenFolder(Path("a")));
+  CHECK(!file_system.Open(Path("a/b")));
+  auto created = file_system.CreateFolder(Path("/a/b/"));
+  REQUIRE(created);
+  CHECK(std::get<Folder>(created) == std::get<Folder>(folder));
+
+  // Empty folders exist on their own, but not in place of files
+  REQUIRE(file_system.CreateFolder(Path("a/empty/nested")));
+  auto empty = file_system.List(Path("a/empty/nested"));
+  REQUIRE(empty);
+  CHECK(std::get<std::vector<FileSystem::Entry>>(empty).empty());
+  CHECK(!file_system.CreateFolder(Path("a/other")));
+  CHECK(!file_system.CreateFolder(Path("a/other/below")));
+  CHECK(!file_system.Create(Path("a/b"), Blob<true>::Filled(10, 1), 4));
+  CHECK(!file_system.CreateFolder(Path("")));
+  CHECK(file_system.Create(Path("/.."), Blob<true>::Filled(10, 1), 4) == Error(errors::ArgumentError()));
+  CHECK(!file_system.Open(Path("")));
+
+  // Deleting a folder deletes its content recursively
+  REQUIRE(file_system.Delete(std::get<Folder>(std::move(file_system.OpenFolder(Path("a"))))));
+  CHECK(!file_system.Open(Path("a/b/file")));
+  CHECK(!file_system.Open(Path("a/other")));
+  CHECK(!file_system.OpenFolder(Path("a/empty")));
+  auto root = file_system.List(Path(""));
+  REQUIRE(root);
+  CHECK(std::get<std::vector<FileSystem::Entry>>(root).empty());
+  auto statistics = file_system.Deduplication();
+  REQUIRE(statistics);
+  CHECK(statistics->references == 0);
+  CHECK(statistics->unique_chunks == 0);
+}
+
+TEST_CASE ("Move and copy") {
+  auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create())));
+  file_system.SetWriteOptions(FileSystem::WriteOptions().SetDeduplicate(true));
+  Blob<true> data(1000);
+  for (FileSystem::SizeType i = 0; i < data.Size(); ++i) {
+	data[i] = static_cast<unsigned char>(i % 97);
+  }
+  REQUIRE(file_system.Create(Path("a/b/file"), data.Copy(), 100));
+  REQUIRE(file_system.Create(Path("a/other"), data.Copy(), 100));
+  REQUIRE(file_system.Create(Path("ab"), data.Copy(), 100));
+
+  // Moving a folder changes the paths of its content, but keeps the file handles
+  const auto handle = std::get<File>(file_system.Open(Path("a/b/file"))).Handle();
+  REQUIRE(!file_system.Move(Path("a"), Path("x/y")).has_value());
+  CHECK(!file_system.Open(Path("a/b/file")));
+  CHECK(!file_system.OpenFolder(Path("a")));
+  auto moved = file_system.Open(Path("x/y/b/file"));
+  REQUIRE(moved);
+  CHECK(std::get<File>(moved).Handle() == handle);
+  CHECK(file_system.Read(std::get<File>(moved), 0, data.Size()) == data);
+  CHECK(file_system.Open(Path("ab")));
+  auto listing = file_system.List(Path("x/y"));
+  REQUIRE(listing);
+  CHECK(std::get<std::vector<FileSystem::Entry>>(listing).size() == 2);
+
+  // Invalid moves are refused without any change
+  CHECK(file_system.Move(Path("x/y"), Path("x/y/b/inside")) == Error(errors::ArgumentError()));
+  CHECK(file_system.Move(Path("ab"), Path("x/y/other")) == Error(errors::Io::FileExists));
+  CHECK(file_system.Move(Path("missing"), Path("somewhere")) == Error(errors::Io::FileNotFound));
+  REQUIRE(!file_system.Move(Path("ab"), Path("renamed")).has_value());
+  CHECK(file_system.Open(Path("renamed")));
+
+  // Copies share the deduplicated chunks and are independent of their source
+  REQUIRE(!file_system.Copy(Path("x"), Path("copy")).has_value());
+  auto copy = file_system.Open(Path("copy/y/b/file"));
+  REQUIRE(copy);
+  CHECK(file_system.Read(std::get<File>(copy), 0, data.Size()) == data);
+  CHECK(file_system.Stat(std::get<File>(copy))->hash == file_system.Stat(std::get<File>(moved))->hash);
+  auto statistics = file_system.Deduplication();
+  REQUIRE(statistics);
+  CHECK(statistics->references == 50);
+  CHECK(statistics->unique_chunks == 10);
+
+  REQUIRE(file_system.Delete(std::get<Folder>(file_system.OpenFolder(Path("x")))));
+  CHECK(file_system.Read(std::get<File>(copy), 0, data.Size()) == data);
+  statistics = file_system.Deduplication();
+  REQUIRE(statistics);
+  CHECK(statistics->references == 30);
+
+  // Chunks stored on their own are copied within the database
+  file_system.SetWriteOptions(FileSystem::WriteOptions());
+  REQUIRE(file_system.Create(Path("plain"), data.Copy(), 100));
+  REQUIRE(!file_system.Copy(Path("plain"), Path("plain copy")).has_value());
+  REQUIRE(file_system.Delete(std::get<File>(file_system.Open(Path("plain")))));
+  auto plain = file_system.Open(Path("plain copy"));
+  REQUIRE(plain);
+  CHECK(file_system.Read(std::get<File>(plain), 0, data.Size()) == data);
+}
+
+TEST_CASE ("Moving folders") {
+  auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create())));
+  const Blob<true> data = Blob<true>::Filled(10, 42);
+  std::vector<std::string> nested;
+  for (int i = 0; i < 10; ++i) {
+	for (int j = 0; j < 10; ++j) {
+	  nested.emplace_back("foo/" + std::to_string(i) + "/" + std::to_string(j) + "/file");
+	}
+  }
+  nested.emplace_back("foo/file");
+  for (const auto &path: nested) {
+	REQUIRE(file_system.Create(Path(path), data.Copy()));
+  }
+
+  // Siblings sort right before and after the range of the folder, with "foo0" being its exclusive upper bound
+  const std::vector<std::string> siblings = {"foo", "foo.txt/file", "foo0", "foo00/file", "fo/file", "fooo/file"};
+  REQUIRE(file_system.Create(Path("foo.txt/file"), data.Copy()));
+  REQUIRE(file_system.Create(Path("foo0"), data.Copy()));
+  REQUIRE(file_system.Create(Path("foo00/file"), data.Copy()));
+  REQUIRE(file_system.Create(Path("fo/file"), data.Copy()));
+  REQUIRE(file_system.Create(Path("fooo/file"), data.Copy()));
+
+  REQUIRE(!file_system.Move(Path("foo"), Path("bar/foo")).has_value());
+  for (const auto &path: nested) {
+	CHECK(!file_system.Open(Path(path)));
+	CHECK(file_system.Open(Path("bar/" + path)));
+  }
+  for (std::size_t i = 1; i < siblings.size(); ++i) {
+	CHECK(file_system.Open(Path(siblings[i])));
+	CHECK(!file_system.Open(Path("bar/" + siblings[i])));
+  }
+  CHECK(!file_system.OpenFolder(Path("foo")));
+  CHECK(file_system.OpenFolder(Path("bar/foo/9/9")));
+  CHECK(std::get<std::vector<FileSystem::Entry>>(file_system.List(Path("bar/foo"))).size() == 11);
+  CHECK(std::get<std::vector<FileSystem::Entry>>(file_system.List(Path("bar"))).size() == 1);
+}
+
+TEST_CASE ("Failed commit of a file") {
+  const std::string container_path = "commit_file.tmp";
+  std::ofstream(container_path, std::ofstream::binary | std::ofstream::trunc).close();
+  {
+	Database::Options options;
+	options.busy_timeout = 0;
+	auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create(container_path,
+																								  options))));
+	auto reader = std::move(std::get<Database>(Database::Create(container_path, options)));
+
+	// The reader keeps the file from being committed, which is reported with the actual status
+	REQUIRE(reader("BEGIN;"));
+	REQUIRE(reader("SELECT count(*) FROM sqlite_master"));
+	auto created = file_system.Create(Path("file"), Blob<true>::Filled(10, 1), 4);
+	REQUIRE(!created);
+	auto *status = std::get<Error>(created).get<sqlite::Status>();
+	REQUIRE(status != nullptr);
+	CHECK(!*status);
+	REQUIRE(reader("COMMIT;"));
+	CHECK(!file_system.Open(Path("file")));
+  }
+  std::filesystem::remove(container_path);
+}
+
+TEST_CASE ("Replacing") {
+  auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create())));
+  Blob<true> data(1000);
+  for (FileSystem::SizeType i = 0; i < data.Size(); ++i) {
+	data[i] = static_cast<unsigned char>(i % 89);
+  }
+  REQUIRE(file_system.Create(Path("file"), data.Copy(), 100));
+
+  // A failed upload does not remove the file it was meant to replace
+  {
+	auto transaction = file_system.Begin();
+	REQUIRE(transaction);
+	REQUIRE(file_system.Delete(std::get<File>(file_system.Open(Path("file")))));
+	auto failing_source = [](int) {
+	  return Blob<true>();
+	};
+	CHECK(!file_system.Create(Path("file"), failing_source, data.Size(), 100));
+  }
+  auto file = file_system.Open(Path("file"));
+  REQUIRE(file);
+  CHECK(file_system.Read(std::get<File>(file), 0, data.Size()) == data);
+
+  // A successful one replaces it once committed
+  {
+	auto transaction = file_system.Begin();
+	REQUIRE(transaction);
+	REQUIRE(file_system.Delete(std::get<File>(std::move(file))));
+	REQUIRE(file_system.Create(Path("file"), Blob<true>(data.Part(10)), 100));
+	CHECK(std::get<sqlite::Transaction>(transaction).Commit());
+  }
+  file = file_system.Open(Path("file"));
+  REQUIRE(file);
+  CHECK(file_system.Size(std::get<File>(file)) == 10);
+
+  // Neither does a failed transfer onto an existing folder
+  REQUIRE(file_system.Create(Path("folder/file"), data.Copy(), 100));
+  {
+	auto transaction = file_system.Begin();
+	REQUIRE(transaction);
+	REQUIRE(file_system.Delete(std::get<Folder>(file_system.OpenFolder(Path("folder")))));
+	CHECK(file_system.Move(Path("missing"), Path("folder")) == Error(errors::Io::FileNotFound));
+  }
+  CHECK(file_system.Open(Path("folder/file")));
+}
+
+TEST_CASE ("Batch") {
+  auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create())));
+  Blob<true> data(100);
+  for (FileSystem::SizeType i = 0; i < data.Size(); ++i) {
+	data[i] = static_cast<unsigned char>(i);
+  }
+
+  {
+	// Files are committed in batches, while a failing file is undone on its own
+	auto batch = file_system.Batch(2);
+	REQUIRE(batch.Create(Path("a"), data.Copy(), 10));
+	REQUIRE(batch.Create(Path("dir/b"), data.Copy(), 30));
+	CHECK(batch.Pending() == 0);
+	REQUIRE(batch.Create(Path("c"), data.Copy(), 10));
+	CHECK(batch.Create(Path("a"), data.Copy(), 10) == Error(errors::Io::FileExists));
+	CHECK(batch.Pending() == 1);
+	REQUIRE(!batch.Commit().has_value());
+	CHECK(batch.Pending() == 0);
+
+	// Files not committed are discarded alongside the writer
+	REQUIRE(batch.Create(Path("d"), data.Copy(), 10));
+  }
+  for (const auto *name: {"a", "dir/b", "c"}) {
+	auto file = file_system.Open(Path(name));
+	REQUIRE_MESSAGE(file, name);
+	CHECK(file_system.Read(std::get<File>(file), 0, data.Size()) == data);
+  }
+  CHECK(!file_system.Open(Path("d")));
+
+  {
+	// Without isolation, a failing file discards the whole batch
+	auto batch = file_system.Batch(10, false);
+	REQUIRE(batch.Create(Path("e"), data.Copy(), 10));
+	CHECK(batch.Create(Path("c"), data.Copy(), 10) == Error(errors::Io::FileExists));
+	CHECK(batch.Pending() == 0);
+	REQUIRE(batch.Create(Path("f"), data.Copy(), 10));
+	REQUIRE(!batch.Commit().has_value());
+  }
+  CHECK(!file_system.Open(Path("e")));
+  CHECK(file_system.Open(Path("f")));
+  CHECK(file_system.Create(Path("g"), data.Copy(), 10));
+}
+
+TEST_CASE ("Import") {
+  auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(Database::Create())));
+  std::filesystem::create_directory("import_source");
+
+  // Files of various sizes, some exceeding the buffer and some empty
+  std::vector<Importer::Job> jobs;
+  for (int i = 0; i < 20; ++i) {
+	Blob<true> data(i * 150);
+	for (FileSystem::SizeType j = 0; j < data.Size(); ++j) {
+	  data[j] = static_cast<unsigned char>((i + j) % 251);
+	}
+	const std::string local_path = "import_source/" + std::to_string(i);
+	REQUIRE(data.Save(local_path));
+	jobs.push_back(Importer::Job{Path("imported/" + std::to_string(i)), local_path});
+  }
+  jobs.push_back(Importer::Job{Path("imported/missing"), "import_source/missing"});
+  jobs.push_back(Importer::Job{Path("imported/0"), "import_source/1"});
+
+  std::vector<std::string> failures;
+  Importer importer(&file_system, Importer::Options{3, 1000, 4, 100});
+  auto summary = importer.Import(jobs, [&](const Importer::Job &job, const Error &) {
+	failures.push_back(job.path.AbsolutePath());
+  });
+  REQUIRE_MESSAGE(summary, summary);
+  CHECK(summary->num_imported == 20);
+  CHECK(summary->num_failed == 2);
+  std::sort(failures.begin(), failures.end());
+  CHECK(failures == std::vector<std::string>{"imported/0", "imported/missing"});
+
+  for (int i = 0; i < 20; ++i) {
+	auto file = file_system.Open(Path("imported/" + std::to_string(i)));
+	REQUIRE(file);
+	auto expected = Blob<true>(std::string_view("import_source/" + std::to_string(i)));
+	CHECK(file_system.Size(std::get<File>(file)) == expected.Size());
+	if (expected.Size() > 0) {
+	  CHECK(file_system.Read(std::get<File>(file), 0, expected.Size()) == expected);
+	}
+	CHECK(file_system.Stat(std::get<File>(file))->hash == util::Sha256::ToHex(util::Sha256::Hash(expected)));
+  }
+  std::filesystem::remove_all("import_source");
+}
+
+TEST_CASE ("Pool") {
+  const std::string container_path = "pool_container.tmp";
+  std::ofstream(container_path, std::ofstream::binary | std::ofstream::trunc).close();
+
+  Blob<true> data(300000);
+  for (FileSystem::SizeType i = 0; i < data.Size(); ++i) {
+	data[i] = static_cast<unsigned char>(i * 13 % 241);
+  }
+  {
+	auto database = Database::Create(container_path, Database::Options::ReadMostly());
+	auto file_system = std::get<FileSystem>(FileSystem::Open(std::get<Database>(std::move(database))));
+	auto file = std::get<File>(file_system.Create(Path("file"), data.Copy(), 4096));
+	REQUIRE(file_system.Create(Path("assets/large"), data.Copy(), 4096));
+	REQUIRE(file_system.Create(Path("assets/sub/small"), Blob<true>(data.Part(10, 5)), 4096));
+	REQUIRE(file_system.Create(Path("assets/sub/deeper/small"), Blob<true>(data.Part(20, 7)), 4096));
+
+	// Read a single file with several connections
+	auto pool = FileSystemPool::Open(container_path, 4, Database::Options::ReadMostly());
+	REQUIRE(pool);
+	auto *connections = std::get<std::unique_ptr<FileSystemPool>>(pool).get();
+	REQUIRE(!file_system.Read(file, "pool_output.tmp", 0, data.Size(), true, true, connections).has_value());
+	CHECK(Blob<true>("pool_output.tmp") == data);
+	std::filesystem::remove("pool_output.tmp");
+  }
+
+  {
+	auto pool_container = FileSystemPool::Open(container_path, 4, Database::Options::ReadMostly());
+	REQUIRE(pool_container);
+	auto &pool = *std::get<std::unique_ptr<FileSystemPool>>(pool_container);
+	CHECK(pool.Size() == 4);
+
+	// The connections are read-only
+	{
+	  auto lease = pool.Acquire();
+	  CHECK(!lease->Create(Path("other"), data.Copy()));
+	}
+
+	// Many threads share the connections and read concurrently
+	std::atomic<int> failures(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 8; ++t) {
+	  threads.emplace_back([&, t]() {
+		for (int i = 0; i < 50; ++i) {
+		  auto lease = pool.Acquire();
+		  auto file = lease->Open(Path("file"));
+		  const FileSystem::SizeType start = (t * 7919 + i * 104729) % (data.Size() - 5000);
+		  if (!file || !(lease->Read(std::get<File>(file), start, 5000) == Blob<true>(data.Part(5000, start)))) {
+			++failures;
+		  }
+		}
+	  });
+	}
+	for (auto &thread: threads) {
+	  thread.join();
+	}
+	CHECK(failures == 0);
+
+	// Split a single read between the connections
+	auto file = std::get<File>(pool.Acquire()->Open(Path("file")));
+	Blob<true> output(data.Size() - 1000);
+	REQUIRE(!pool.Read(file, 1000, output.Data(), output.Size()).has_value());
+	CHECK(output == Blob<true>(data.Part(output.Size(), 1000)));
+	CHECK(pool.Read(file, 1000, output.Data(), data.Size()) == Error(errors::Io::OutOfBounds));
+
+	// A caller holding leases itself splits the read among the remaining connections only
+	{
+	  std::vector<FileSystemPool::Lease> held;
+	  for (std::size_t i = 1; i < pool.Size(); ++i) {
+		held.emplace_back(pool.Acquire());
+	  }
+	  Blob<true> shared_output(data.Size());
+	  REQUIRE(!pool.Read(file, 0, shared_output.Data(), shared_output.Size()).has_value());
+	  CHECK(shared_output == data);
+	  const auto held_summary = pool.Export(Path("assets/sub/*"), "pool_export");
+	  CHECK(held_summary.num_exported == 2);
+	  std::filesystem::remove_all("pool_export");
+	}
+
+	std::ofstream("pool_output.tmp", std::ofstream::binary | std::ofstream::trunc).close();
+	REQUIRE(!pool.Read(file, "pool_output.tmp", 0, data.Size()).has_value());
+	CHECK(Blob<true>("pool_output.tmp") == data);
+	std::filesystem::remove("pool_output.tmp");
+
+	// Export files matching a pattern, keeping their relative paths
+	int num_failures = 0;
+	const auto summary = pool.Export(Path("assets/*"), "pool_export", [&](const Path &, const Error &) {
+	  ++num_failures;
+	});
+	CHECK(summary.num_exported == 3);
+	CHECK(summary.num_failed == 0);
+	CHECK(num_failures == 0);
+	CHECK(summary.bytes_exported == data.Size() + 30);
+	CHECK(Blob<true>("pool_export/assets/large") == data);
+	CHECK(Blob<true>("pool_export/assets/sub/small") == Blob<true>(data.Part(10, 5)));
+	CHECK(Blob<true>("pool_export/assets/sub/deeper/small") == Blob<true>(data.Part(20, 7)));
+	CHECK(!std::filesystem::exists("pool_export/file"));
+	std::filesystem::remove_all("pool_export");
+
+	// All connections are returned
+	std::vector<FileSystemPool::Lease> leases;
+	for (std::size_t i = 0; i < pool.Size(); ++i) {
+	  auto lease = pool.TryAcquire();
+	  REQUIRE(lease.has_value());
+	  leases.emplace_back(std::move(lease.value()));
+	}
+	CHECK(!pool.TryAcquire().has_value());
+  }
+  CHECK(FileSystemPool::Open(container_path, 0) == Error(errors::ArgumentError()));
+  std::filesystem::remove(container_path);
+  std::filesystem::remove(container_path + "-wal");
+  std::filesystem::remove(container_path + "-shm");
+}
+
+TEST_CASE ("Large files") {
+  // The local file is sparse, so only the container itself requires the space on disk
+  const FileSystem::SizeType size = (FileSystem::SizeType(1) << 31) + 4242;
+  const std::string local_file_path = "large_file.tmp", container_path = "large_container.tmp";
+  {
+	std::ofstream local_file(local_file_path, std::ofstream::binary | std::ofstream::trunc);
+	local_file.seekp(size - 2);
+	local_file.write("\x2A\x2B", 2);
+	REQUIRE(local_file);
+
+	// An empty file is a valid SQLite database
+	std::ofstream container(container_path, std::ofstream::binary | std::ofstream::trunc);
+  }
+
+  {
+	auto database = Database::Create(container_path);
+	REQUIRE(database);
+	auto file_system_container = FileSystem::Open(std::move(std::get<Database>(database)));
+	REQUIRE_MESSAGE(file_system_container, file_system_container);
+	auto file_system = std::get<FileSystem>(std::move(file_system_container));
+
+	auto file_container = file_system.Create(Path("large_file"), local_file_path, 64 * 1024 * 1024);
+	REQUIRE_MESSAGE(file_container, file_container);
+	auto file = std::get<File>(std::move(file_container));
+	CHECK(file_system.Size(file) == size);
+
+	// Read the end of the file
+	auto read_blob = file_system.Read(file, size - 2, 2);
+	REQUIRE(read_blob);
+	CHECK(read_blob->operator[](0) == 0x2A);
+	CHECK(read_blob->operator[](1) == 0x2B);
+
+	// Read across the 2 GiB border
+	read_blob = file_system.Read(file, (FileSystem::SizeType(1) << 31) - 2, 4);
+	REQUIRE(read_blob);
+	CHECK(read_blob == Blob<true>::Filled(4, 0));
+	CHECK(file_system.Read(file, size, 1) == Error(errors::Io::OutOfBounds));
+  }
+
+  std::filesystem::remove(local_file_path);
+  std::filesystem::remove(container_path);
+}
+
 TEST_CASE ("Empty files") {
 auto database = std::get<Database>(Database::Create());
 auto file_system_container = FileSystem::Open(std::move(database));
@@ -20,6 +20,7 @@ TEST_CASE ("ID") {
   MetaTable meta(42);
   CHECK(meta.Meta() == "Matryoshka_Meta_42");
   CHECK(meta.Data() == "Matryoshka_Data");
+  CHECK(meta.Content() == "Matryoshka_Content");
   CHECK(meta.Id() == 42);
 }
 
@@ -42,6 +43,7 @@ TEST_CASE ("Format") {
   CHECK(meta.Format("{meta} abc {data}") == "Matryoshka_Meta_0 abc Matryoshka_Data");
   CHECK(meta.Format("{meta} abc {data} {data}") == "Matryoshka_Meta_0 abc Matryoshka_Data Matryoshka_Data");
   CHECK(meta.Format("{meta} abc {data}{data}") == "Matryoshka_Meta_0 abc Matryoshka_DataMatryoshka_Data");
+  CHECK(meta.Format("{content} abc {data}{meta}") == "Matryoshka_Content abc Matryoshka_DataMatryoshka_Meta_0");
 }
 }
 
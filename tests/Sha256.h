@@ -0,0 +1,43 @@
+/*
+This file is part of Matryoshka.
+Copyright (C) 2020 Christopher Gundler <christopher@gundler.de>
+This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRYOSHKA_TESTS_SHA256_H_
+#define MATRYOSHKA_TESTS_SHA256_H_
+
+#include "../matryoshka/data/util/Sha256.h"
+
+#include <string_view>
+
+using namespace matryoshka::data::util;
+
+TEST_SUITE ("Sha256") {
+TEST_CASE ("Known digests") {
+  auto hash = [](std::string_view input) {
+	Sha256 sha;
+	sha.Update(reinterpret_cast<const unsigned char *>(input.data()), input.size());
+	return Sha256::ToHex(sha.Finish());
+  };
+
+  CHECK(hash("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  CHECK(hash("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+  CHECK(hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")
+			== "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+}
+
+TEST_CASE ("Incremental") {
+  const auto data = sqlite::Blob<true>::Filled(1000000, 'a');
+  Sha256 sha;
+  for (sqlite::BlobBase::SizeType i = 0; i < data.Size(); i += 333) {
+	sha.Update(data.Data() + i, static_cast<std::size_t>(std::min<sqlite::BlobBase::SizeType>(333, data.Size() - i)));
+  }
+  CHECK(Sha256::ToHex(sha.Finish()) == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+  CHECK(Sha256::Hash(data) == Sha256::Hash(data));
+}
+}
+
+#endif //MATRYOSHKA_TESTS_SHA256_H_
@@ -11,6 +11,9 @@ You should have received a copy of the GNU Affero General Public License along w
 
 #include <doctest/doctest.h>
 
+#include <fstream>
+#include <filesystem>
+
 #include "../matryoshka/data/sqlite/Database.h"
 #include "../matryoshka/data/sqlite/PreparedStatement.h"
 #include "../matryoshka/data/sqlite/Query.h"
@@ -177,6 +180,69 @@ TEST_CASE ("Blob") {
   CHECK(example[2] == 66);
   CHECK(example[3] == 7);
 };
+
+TEST_CASE ("Options") {
+  CHECK(Database::Options::Preset("bulk-import").has_value());
+  CHECK(Database::Options::Preset("read-mostly").has_value());
+  CHECK(Database::Options::Preset("durable").has_value());
+  CHECK(!Database::Options::Preset("fast").has_value());
+
+  const std::string path = "options.tmp";
+  std::ofstream(path, std::ofstream::binary | std::ofstream::trunc).close();
+  {
+	auto database_creation = Database::Create(path, Database::Options::ReadMostly());
+	REQUIRE(database_creation);
+	auto database = std::move(std::get<Database>(database_creation));
+	auto pragma = [&](std::string_view name) {
+	  auto statement = PreparedStatement::Create(database, std::string("PRAGMA ").append(name));
+	  REQUIRE(statement);
+	  std::string value;
+	  std::get<PreparedStatement>(statement)([&](Query &query) {
+		return query().Than([&]() {
+		  value = query.Get<std::string>(0);
+		  return Status();
+		});
+	  });
+	  return value;
+	};
+	CHECK(pragma("journal_mode") == "wal");
+	CHECK(pragma("synchronous") == "1");
+	CHECK(pragma("page_size") == "16384");
+	CHECK(pragma("cache_size") == "-65536");
+	CHECK(pragma("busy_timeout") == "5000");
+  }
+  std::filesystem::remove(path);
+  std::filesystem::remove(path + "-wal");
+  std::filesystem::remove(path + "-shm");
+}
+
+TEST_CASE ("Failed commit") {
+  const std::string path = "commit.tmp";
+  std::ofstream(path, std::ofstream::binary | std::ofstream::trunc).close();
+  {
+	Database::Options options;
+	options.busy_timeout = 0;
+	auto writer = std::move(std::get<Database>(Database::Create(path, options)));
+	auto reader = std::move(std::get<Database>(Database::Create(path, options)));
+	REQUIRE(writer("CREATE TABLE test (id INTEGER)"));
+
+	// A reader within a transaction keeps the writer from committing in rollback journal mode
+	REQUIRE(reader("BEGIN;"));
+	REQUIRE(reader("SELECT count(*) FROM test"));
+	auto transaction = std::move(std::get<Transaction>(Transaction::Open(&writer)));
+	REQUIRE(writer("INSERT INTO test VALUES (42)"));
+	CHECK(!transaction.Commit());
+	CHECK(writer.IsInTransaction());
+
+	// The transaction is still open and rolled back on its own
+	CHECK(transaction.Rollback());
+	CHECK(!writer.IsInTransaction());
+	REQUIRE(reader("COMMIT;"));
+	auto transaction_2 = std::move(std::get<Transaction>(Transaction::Open(&writer)));
+	CHECK(transaction_2.Commit());
+  }
+  std::filesystem::remove(path);
+}
 }
 
 #endif //MATRYOSHKA_TESTS_SQLITE_H_
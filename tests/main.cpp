@@ -13,4 +13,6 @@ You should have received a copy of the GNU Affero General Public License along w
 #include "Path.h"
 #include "MetaTable.h"
 #include "FileSystem.h"
-#include "Cache.h"
\ No newline at end of file
+#include "Cache.h"
+#include "Sha256.h"
+#include "Codec.h"
\ No newline at end of file